@@ -0,0 +1,90 @@
+/**
+ * This file contains the implementation of the Benchmark class, along with
+ * the replacement of the global operator new used to count allocations.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "Benchmark.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+
+namespace {
+std::atomic<std::size_t> allocation_count{0};
+}
+
+void* operator new(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* memory{std::malloc(size == 0 ? 1 : size)}; memory != nullptr) {
+    return memory;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+Benchmark::Benchmark(double min_seconds) : m_min_seconds{min_seconds} {}
+
+void Benchmark::measure(Result result, const std::function<void()>& body) {
+  std::size_t allocations_before{allocations()};
+  auto start{std::chrono::steady_clock::now()};
+  double elapsed{0};
+  do {
+    body();
+    ++result.iterations;
+    elapsed = std::chrono::duration<double>{std::chrono::steady_clock::now()
+                                            - start}
+                  .count();
+  } while (elapsed < m_min_seconds);
+
+  result.seconds = elapsed / static_cast<double>(result.iterations);
+  result.allocations =
+      static_cast<double>(allocations() - allocations_before)
+      / static_cast<double>(result.iterations);
+  struct rusage usage {};
+  ::getrusage(RUSAGE_SELF, &usage);
+  result.process_peak_rss_kib = usage.ru_maxrss;
+  m_results.push_back(std::move(result));
+}
+
+const std::vector<Benchmark::Result>& Benchmark::results() const {
+  return m_results;
+}
+
+void Benchmark::writeJson(std::ostream& output) const {
+  output << "{\n  \"results\": [";
+  bool first{true};
+  for (const auto& result: m_results) {
+    double nanoseconds{result.seconds * 1e9};
+    output << (first ? "\n" : ",\n") << "    {\"suite\": \"" << result.suite
+           << "\", \"name\": \"" << result.name << "\", \"phase\": \""
+           << result.phase << "\", \"input_bytes\": " << result.input_bytes
+           << ", \"states\": " << result.states
+           << ", \"dfa_states\": " << result.dfa_states
+           << ", \"iterations\": " << result.iterations
+           << ", \"ns\": " << nanoseconds << ", \"ns_per_byte\": "
+           << (result.input_bytes == 0
+                   ? 0
+                   : nanoseconds / static_cast<double>(result.input_bytes))
+           << ", \"allocations\": " << result.allocations
+           << ", \"process_peak_rss_kib\": " << result.process_peak_rss_kib
+           << "}";
+    first = false;
+  }
+  output << "\n  ]\n}\n";
+}
+
+std::size_t Benchmark::allocations() {
+  return allocation_count.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,88 @@
+/**
+ * This file contains the definition of the Benchmark class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_BENCHMARK_H
+#define REGEXP_BENCHMARK_H
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Benchmark {
+public:
+  /**
+   * The outcome of measuring a single case.
+   */
+  struct Result {
+    std::string suite{};
+    std::string name{};
+    std::string phase{};
+    std::size_t input_bytes = 0;
+    std::size_t states = 0;
+    std::size_t dfa_states = 0;
+    std::size_t iterations = 0;
+    double seconds = 0;
+    double allocations = 0;
+    long process_peak_rss_kib = 0;
+  };
+
+  /**
+   * Construct a benchmark that repeats every measured case until it took at
+   * least the given amount of time.
+   *
+   * @param min_seconds the minimum time to spend on a case
+   */
+  explicit Benchmark(double min_seconds);
+
+  /**
+   * Measure a case by running it repeatedly. The iterations, the time per
+   * iteration, the allocations per iteration and the peak resident set size
+   * of the process so far are filled in. The latter never decreases, so it is
+   * an upper bound rather than the memory used by this case.
+   *
+   * @param result the description of the case to complete and record
+   * @param body the case to run
+   */
+  void measure(Result result, const std::function<void()>& body);
+
+  /**
+   * Get the results measured so far.
+   *
+   * @return the results in the order they were measured
+   */
+  [[nodiscard]] const std::vector<Result>& results() const;
+
+  /**
+   * Write the results measured so far as a JSON document.
+   *
+   * @param output the stream to write to
+   */
+  void writeJson(std::ostream& output) const;
+
+  /**
+   * Get the number of allocations performed by the process so far.
+   *
+   * @return the number of calls to the global operator new
+   */
+  static std::size_t allocations();
+
+private:
+  /**
+   * The minimum time to spend on a case.
+   */
+  double m_min_seconds;
+
+  /**
+   * The results measured so far.
+   */
+  std::vector<Result> m_results{};
+};
+
+#endif
@@ -0,0 +1,163 @@
+/**
+ * This file contains the implementation of the Comparison class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "Comparison.h"
+#include "Matcher.h"
+#include "RegularExpression.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <regex>
+
+namespace {
+/**
+ * The maximum length of a generated input. std::regex backtracks, so
+ * patterns like (a|aa)* take time exponential in the input length.
+ */
+constexpr std::size_t MAX_INPUT_LENGTH{24};
+
+/**
+ * Generate a random pattern following ⟨expr⟩, which std::regex parses with
+ * the same meaning. Nested alternations are parenthesized so nullability is
+ * tracked exactly, and stars are never put around patterns matching the empty
+ * string, on which std::regex would backtrack exponentially.
+ *
+ * @param generator the random generator to use
+ * @param nullable set to whether the pattern matches the empty string
+ * @param depth the nesting depth of the pattern being generated
+ * @return the pattern
+ */
+std::string generatePattern(std::mt19937& generator, bool& nullable,
+                            int depth = 0) {
+  std::uniform_real_distribution<double> choice{0, 1};
+  double kind{choice(generator)};
+  std::string pattern{};
+  bool left_nullable{false};
+  bool right_nullable{false};
+  if (depth > 3 || kind < 0.35) {
+    pattern = static_cast<char>('a' + generator() % 3);
+    nullable = false;
+  } else if (kind < 0.6) {
+    pattern = generatePattern(generator, left_nullable, depth + 1)
+              + generatePattern(generator, right_nullable, depth + 1);
+    nullable = left_nullable && right_nullable;
+  } else if (kind < 0.8) {
+    pattern = generatePattern(generator, left_nullable, depth + 1) + '|'
+              + generatePattern(generator, right_nullable, depth + 1);
+    if (depth > 0) {
+      pattern = '(' + pattern + ')';
+    }
+    nullable = left_nullable || right_nullable;
+  } else {
+    pattern = '(' + generatePattern(generator, nullable, depth + 1) + ')';
+  }
+
+  if (!nullable && choice(generator) < 0.25) {
+    pattern = (pattern.size() > 1 ? '(' + pattern + ')' : pattern) + '*';
+    nullable = true;
+  }
+  return pattern;
+}
+} // namespace
+
+Comparison::Comparison(std::uint32_t seed, std::size_t patterns,
+                       std::size_t inputs)
+    : m_seed{seed}, m_patterns{patterns}, m_inputs{inputs} {}
+
+void Comparison::run() {
+  std::mt19937 generator{m_seed};
+  for (std::size_t pattern_number{0}; pattern_number < m_patterns;
+       ++pattern_number) {
+    bool nullable{false};
+    std::string pattern{generatePattern(generator, nullable)};
+    std::vector<std::string> inputs(m_inputs);
+    for (auto& input: inputs) {
+      input.resize(generator() % (MAX_INPUT_LENGTH + 1));
+      for (auto& character: input) {
+        character = static_cast<char>('a' + generator() % 4);
+      }
+      m_bytes += input.size();
+    }
+    m_matches += inputs.size();
+
+    std::vector<char> results(inputs.size());
+    auto start{std::chrono::steady_clock::now()};
+    RegularExpression expression{pattern};
+    for (std::size_t index{0}; index < inputs.size(); ++index) {
+      results[index] = expression.mat(inputs[index]) ? 1 : 0;
+    }
+    auto middle{std::chrono::steady_clock::now()};
+    std::regex reference{pattern, std::regex::ECMAScript};
+    std::vector<char> reference_results(inputs.size());
+    for (std::size_t index{0}; index < inputs.size(); ++index) {
+      reference_results[index] = std::regex_match(inputs[index], reference);
+    }
+    auto end{std::chrono::steady_clock::now()};
+    m_seconds += std::chrono::duration<double>{middle - start}.count();
+    m_reference_seconds += std::chrono::duration<double>{end - middle}.count();
+
+    // Inputs this short are only simulated on the NFA by mat(), so the paths
+    // taken for batches, streams and long strings are checked separately
+    std::vector<std::string_view> views(inputs.begin(), inputs.end());
+    RegularExpression::Scratch scratch{};
+    std::vector<char> batch_results{};
+    expression.matBatch(views, scratch, batch_results);
+    const Dfa* dfa{expression.dfa()};
+    Matcher matcher{expression};
+    for (std::size_t index{0}; index < inputs.size(); ++index) {
+      std::string_view input{inputs[index]};
+      bool expected{reference_results[index] == 1};
+      auto check{[&](const char* path, bool result) {
+        if (result != expected) {
+          m_mismatches.push_back({pattern, inputs[index], expected, path});
+        }
+      }};
+      check("mat", results[index] == 1);
+      check("matBatch", batch_results[index] == 1);
+      if (dfa != nullptr) {
+        check("dfa", dfa->accepting(dfa->run(dfa->initialState(), input)));
+      }
+      while (!input.empty()) { // In chunks of random sizes
+        std::size_t chunk_size{generator() % 4 + 1};
+        matcher.feed(input.substr(0, chunk_size));
+        input.remove_prefix(std::min(chunk_size, input.size()));
+      }
+      check("Matcher", matcher.finish());
+    }
+  }
+}
+
+bool Comparison::agreed() const {
+  return m_mismatches.empty();
+}
+
+void Comparison::writeJson(std::ostream& output) const {
+  auto throughput{[&](double seconds) {
+    return seconds > 0 ? static_cast<double>(m_bytes) / seconds : 0;
+  }};
+  output << "{\n  \"comparison\": {\"seed\": " << m_seed
+         << ", \"patterns\": " << m_patterns << ", \"matches\": " << m_matches
+         << ", \"bytes\": " << m_bytes << ", \"mismatches\": "
+         << m_mismatches.size() << ",\n    \"regexp\": {\"seconds\": "
+         << m_seconds << ", \"bytes_per_second\": " << throughput(m_seconds)
+         << "},\n    \"std_regex\": {\"seconds\": " << m_reference_seconds
+         << ", \"bytes_per_second\": " << throughput(m_reference_seconds)
+         << "},\n    \"speedup\": "
+         << (m_seconds > 0 ? m_reference_seconds / m_seconds : 0)
+         << ",\n    \"examples\": [";
+  std::size_t examples{std::min<std::size_t>(m_mismatches.size(), 10)};
+  for (std::size_t index{0}; index < examples; ++index) {
+    const auto& mismatch{m_mismatches[index]};
+    output << (index == 0 ? "\n" : ",\n") << "      {\"pattern\": \""
+           << mismatch.pattern << "\", \"input\": \"" << mismatch.input
+           << "\", \"path\": \"" << mismatch.path
+           << "\", \"std_regex\": " << (mismatch.expected ? "true" : "false")
+           << "}";
+  }
+  output << (examples == 0 ? "]" : "\n    ]") << "\n  }\n}\n";
+}
@@ -0,0 +1,105 @@
+/**
+ * This file contains the definition of the Comparison class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_COMPARISON_H
+#define REGEXP_COMPARISON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Comparison {
+public:
+  /**
+   * Construct a comparison of this engine with std::regex on randomly
+   * generated patterns that both grammars accept.
+   *
+   * @param seed the seed of the generator, so runs are reproducible
+   * @param patterns the number of patterns to generate
+   * @param inputs the number of inputs to generate per pattern
+   */
+  Comparison(std::uint32_t seed, std::size_t patterns, std::size_t inputs);
+
+  /**
+   * Match every input against every pattern with both engines, recording
+   * disagreements and the time each engine took. Besides mat(), the results
+   * of matBatch(), the DFA and a Matcher fed in chunks are checked too.
+   */
+  void run();
+
+  /**
+   * Get whether both engines agreed on every input.
+   *
+   * @return true if no mismatches were found, false otherwise
+   */
+  [[nodiscard]] bool agreed() const;
+
+  /**
+   * Write the outcome of the comparison as a JSON document, including up to
+   * ten of the mismatches.
+   *
+   * @param output the stream to write to
+   */
+  void writeJson(std::ostream& output) const;
+
+private:
+  /**
+   * An input on which the engines disagreed, and the path of this engine that
+   * gave the other result.
+   */
+  struct Mismatch {
+    std::string pattern{};
+    std::string input{};
+    bool expected = false;
+    const char* path = "";
+  };
+
+  /**
+   * The seed of the generator.
+   */
+  std::uint32_t m_seed;
+
+  /**
+   * The number of patterns to generate.
+   */
+  std::size_t m_patterns;
+
+  /**
+   * The number of inputs to generate per pattern.
+   */
+  std::size_t m_inputs;
+
+  /**
+   * The number of matches performed per engine.
+   */
+  std::size_t m_matches{0};
+
+  /**
+   * The number of bytes matched per engine.
+   */
+  std::size_t m_bytes{0};
+
+  /**
+   * The time spent compiling and matching by this engine.
+   */
+  double m_seconds{0};
+
+  /**
+   * The time spent compiling and matching by std::regex.
+   */
+  double m_reference_seconds{0};
+
+  /**
+   * The inputs on which the engines disagreed.
+   */
+  std::vector<Mismatch> m_mismatches{};
+};
+
+#endif
@@ -0,0 +1,300 @@
+/**
+ * This file defines a reproducible benchmark suite for the construction and
+ * matching of regular expressions, reporting its results as JSON.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "Benchmark.h"
+#include "Comparison.h"
+#include "RegularExpression.h"
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+/**
+ * A family of regular expressions sharing a shape, instantiated for several
+ * sizes.
+ */
+struct Suite {
+  std::string name{};
+  std::vector<std::size_t> sizes{};
+  std::function<std::string(std::size_t)> pattern{};
+  std::function<std::string(std::size_t, std::size_t)> input{};
+  bool scales_input = true;
+};
+
+/**
+ * Get a word that is unique for the given number, consisting of lowercase
+ * letters only.
+ *
+ * @param number the number to get the word for
+ * @return the word
+ */
+std::string word(std::size_t number) {
+  std::string result{"w"};
+  do {
+    result += static_cast<char>('a' + number % 26);
+    number /= 26;
+  } while (number != 0);
+  return result;
+}
+
+/**
+ * Get a string of the given length consisting of a repeated pattern.
+ *
+ * @param pattern the pattern to repeat
+ * @param length the length of the string
+ * @return the string
+ */
+std::string repeat(std::string_view pattern, std::size_t length) {
+  std::string result(length, '\0');
+  for (std::size_t index{0}; index < length; ++index) {
+    result[index] = pattern[index % pattern.size()];
+  }
+  return result;
+}
+
+/**
+ * Get the suites of the benchmark. Inputs are generated deterministically, so
+ * runs on different machines or revisions measure the same work.
+ *
+ * @return the suites
+ */
+std::vector<Suite> suites() {
+  std::vector<Suite> result{};
+
+  result.push_back({"nested_stars", {1, 4, 16, 64},
+                    [](std::size_t depth) {
+                      std::string pattern{"a*"};
+                      for (std::size_t level{1}; level < depth; ++level) {
+                        pattern = '(' + pattern + ")*";
+                      }
+                      return pattern;
+                    },
+                    [](std::size_t, std::size_t bytes) {
+                      return std::string(bytes, 'a');
+                    }});
+
+  result.push_back({"alternation_words", {10, 100, 1000},
+                    [](std::size_t words) {
+                      std::string pattern{word(0)};
+                      for (std::size_t number{1}; number < words; ++number) {
+                        pattern += '|' + word(number);
+                      }
+                      return pattern;
+                    },
+                    [](std::size_t words, std::size_t) {
+                      return word(words - 1);
+                    },
+                    false});
+
+  result.push_back({"alternation_starred", {10, 100, 1000},
+                    [](std::size_t words) {
+                      std::string pattern{'(' + word(0)};
+                      for (std::size_t number{1}; number < words; ++number) {
+                        pattern += '|' + word(number);
+                      }
+                      return pattern + ")*";
+                    },
+                    [](std::size_t words, std::size_t bytes) {
+                      std::mt19937 generator{42};
+                      std::string input{};
+                      while (input.size() < bytes) {
+                        input += word(generator() % words);
+                      }
+                      input.resize(bytes);
+                      return input;
+                    }});
+
+  result.push_back({"concatenation", {100, 1000, 4000},
+                    [](std::size_t length) {
+                      return repeat("abcdefghijklmnopqrstuvwxyz", length);
+                    },
+                    [](std::size_t length, std::size_t) {
+                      return repeat("abcdefghijklmnopqrstuvwxyz", length);
+                    },
+                    false});
+
+  result.push_back({"nested_concatenation", {10, 100, 1000, 5000},
+                    [](std::size_t depth) {
+                      return repeat("(a", 2 * depth) + std::string(depth, ')');
+                    },
+                    [](std::size_t depth, std::size_t) {
+                      return std::string(depth, 'a');
+                    },
+                    false});
+
+  result.push_back({"a_or_aa_star", {1, 2, 3},
+                    [](std::size_t variant) {
+                      return std::vector<std::string>{
+                          "(a|aa)*", "(a|aa)*b", "((a|aa)*)*b"}[variant - 1];
+                    },
+                    [](std::size_t, std::size_t bytes) {
+                      return std::string(bytes, 'a');
+                    }});
+
+  result.push_back({"dfa_state_limit", {8, 12},
+                    [](std::size_t length) {
+                      std::string pattern{"(a|b)*a"};
+                      for (std::size_t index{0}; index < length; ++index) {
+                        pattern += "(a|b)";
+                      }
+                      return pattern;
+                    },
+                    [](std::size_t, std::size_t bytes) {
+                      std::mt19937 generator{42};
+                      std::string input(bytes, 'a');
+                      for (auto& character: input) {
+                        character = generator() % 2 == 0 ? 'a' : 'b';
+                      }
+                      return input;
+                    }});
+
+  return result;
+}
+
+/**
+ * Parse a command line argument as a non-negative number, rejecting anything
+ * following the number.
+ *
+ * @tparam Number the type of the number
+ * @param argument the argument to parse
+ * @param number set to the number if the argument is valid
+ * @return true if the argument is a finite, non-negative number, false
+ *         otherwise
+ */
+template <typename Number>
+bool parseNumber(std::string_view argument, Number& number) {
+  Number parsed{};
+  const char* end{argument.data() + argument.size()};
+  if (argument.empty() || argument.front() == '-') { // Unsigned would wrap
+    return false;
+  } else if (auto [last, error]{std::from_chars(argument.data(), end, parsed)};
+             error != std::errc{} || last != end) {
+    return false;
+  } else if constexpr (std::is_floating_point_v<Number>) {
+    if (!std::isfinite(parsed)) {
+      return false;
+    }
+  }
+  number = parsed;
+  return true;
+}
+
+/**
+ * Entry point of the benchmark.
+ *
+ * @param argc the number of arguments
+ * @param argv the arguments
+ * @return EXIT_SUCCESS if the benchmark ran successfully, EXIT_FAILURE
+ *         otherwise
+ */
+int main(int argc, char* argv[]) {
+  std::size_t max_bytes{std::size_t{1} << 24};
+  double min_seconds{0.2};
+  std::string filter{};
+  bool compare{false};
+  std::uint32_t seed{1};
+  std::size_t patterns{500};
+  for (int index{1}; index < argc; ++index) {
+    std::string_view argument{argv[index]};
+    bool valid{index + 1 < argc}; // Of the value following the argument
+    if (argument == "--compare") {
+      compare = true;
+      valid = true;
+    } else if (argument == "--seed" && valid) {
+      valid = parseNumber(argv[++index], seed);
+    } else if (argument == "--patterns" && valid) {
+      valid = parseNumber(argv[++index], patterns);
+    } else if (argument == "--max-bytes" && valid) {
+      valid = parseNumber(argv[++index], max_bytes)
+              && max_bytes > 0; // Sizes start at 1 B
+    } else if (argument == "--min-time" && valid) {
+      valid = parseNumber(argv[++index], min_seconds);
+    } else if (argument == "--filter" && valid) {
+      filter = argv[++index];
+    } else {
+      valid = false;
+    }
+
+    if (!valid) {
+      std::cerr << "Usage: " << argv[0]
+                << " [--max-bytes <bytes>] [--min-time <seconds>]"
+                   " [--filter <suite>]\n"
+                   "       "
+                << argv[0]
+                << " --compare [--seed <seed>] [--patterns <count>]\n"
+                   "Input sizes run from 1 B up to --max-bytes (default "
+                   "16 MiB, at least 1 B, at most 1 GiB).\n"
+                   "--compare checks the results against std::regex on "
+                   "generated patterns instead.\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (compare) {
+    Comparison comparison{seed, patterns, 100};
+    comparison.run();
+    comparison.writeJson(std::cout);
+    return comparison.agreed() ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  Benchmark benchmark{min_seconds};
+  for (const auto& suite: suites()) {
+    if (suite.name.find(filter) == std::string::npos) {
+      continue;
+    }
+
+    for (auto size: suite.sizes) {
+      std::string pattern{suite.pattern(size)};
+      std::string name{suite.name + "/" + std::to_string(size)};
+      RegularExpression expression{pattern};
+      const Dfa* dfa{expression.dfa()};
+      benchmark.measure({suite.name, name, "construct", pattern.size(),
+                         expression.states(), dfa == nullptr ? 0 : dfa->size()},
+                        [&] { RegularExpression constructed{pattern}; });
+      benchmark.measure({suite.name, name, "determinize", pattern.size(),
+                         expression.states(), dfa == nullptr ? 0 : dfa->size()},
+                        [&] {
+                          RegularExpression constructed{pattern};
+                          static_cast<void>(constructed.dfa());
+                        });
+
+      std::vector<std::size_t> input_sizes{0};
+      if (suite.scales_input) {
+        input_sizes.clear();
+        for (std::size_t bytes{1}; bytes <= max_bytes && bytes <= (1U << 30);
+             bytes *= 1024) {
+          input_sizes.push_back(bytes);
+        }
+        if (max_bytes < (1U << 30) && input_sizes.back() != max_bytes) {
+          input_sizes.push_back(max_bytes);
+        }
+      }
+      for (auto bytes: input_sizes) {
+        std::string input{suite.input(size, bytes)};
+        bool match{};
+        benchmark.measure({suite.name, name, "match", input.size(),
+                           expression.states(),
+                           dfa == nullptr ? 0 : dfa->size()},
+                          [&] { match = expression.mat(input); });
+        static_cast<void>(match);
+      }
+    }
+  }
+
+  benchmark.writeJson(std::cout);
+  return EXIT_SUCCESS;
+}
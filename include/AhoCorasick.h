@@ -0,0 +1,137 @@
+/**
+ * This file contains the definition of the AhoCorasick class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_AHOCORASICK_H
+#define REGEXP_AHOCORASICK_H
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class AhoCorasick {
+public:
+  /**
+   * Construct an Aho-Corasick automaton recognising the given literals.
+   *
+   * The failure links are folded into a dense transition table, so every
+   * character of an input costs a single table lookup.
+   *
+   * @param literals the literals, each accompanied by the tag to report for it
+   */
+  explicit AhoCorasick(
+      const std::vector<std::pair<std::string_view, int>>& literals);
+
+  /**
+   * The state in which reading starts, the root of the trie.
+   */
+  static constexpr int ROOT{0};
+
+  /**
+   * Check whether the given string equals one of the literals.
+   *
+   * @param string the string to check
+   * @return true if the string equals a literal, false otherwise
+   */
+  [[nodiscard]] bool accepts(std::string_view string) const;
+
+  /**
+   * Get the tags of the literals that equal the given string.
+   *
+   * @param string the string to check
+   * @return the distinct tags in ascending order
+   */
+  [[nodiscard]] std::vector<int> matchWhole(std::string_view string) const;
+
+  /**
+   * Get the tags of the literals that occur somewhere in the given string.
+   * Searching stops as soon as every tag has been found.
+   *
+   * @param string the string to search
+   * @return the distinct tags in ascending order
+   */
+  [[nodiscard]] std::vector<int> search(std::string_view string) const;
+
+  /**
+   * Read a string from a state on the trie, as long as it stays on the trie.
+   *
+   * @param state the state to start reading in, ROOT or a state that was
+   *              returned by an earlier walk
+   * @param string the string to read
+   * @return the state of the trie path extended by the string, or -1 if there
+   *         is no such path
+   */
+  [[nodiscard]] int walk(int state, std::string_view string) const;
+
+  /**
+   * Check whether a literal ends exactly in the given state.
+   *
+   * @param state the state to check
+   * @return true if a literal ends in the state, false otherwise
+   */
+  [[nodiscard]] bool accepting(int state) const;
+
+private:
+  /**
+   * For every character, the class of characters it belongs to. Characters
+   * that do not occur in any literal share class 0.
+   */
+  std::array<int, 256> m_class_of{};
+
+  /**
+   * The number of character classes.
+   */
+  int m_classes{1};
+
+  /**
+   * The transition table, indexed by state * m_classes + class. State 0 is the
+   * root of the trie.
+   */
+  std::vector<int> m_goto{};
+
+  /**
+   * For every state, the length of the trie path leading to it.
+   */
+  std::vector<int> m_depth{};
+
+  /**
+   * For every state, the tags of the literals ending exactly in it.
+   */
+  std::vector<std::vector<int>> m_tags{};
+
+  /**
+   * For every state, the nearest state on its failure chain that has tags, or
+   * -1 if there is none.
+   */
+  std::vector<int> m_output_link{};
+
+  /**
+   * The largest tag plus one.
+   */
+  int m_tag_count{0};
+
+  /**
+   * The number of distinct tags.
+   */
+  std::size_t m_distinct_tags{0};
+
+  /**
+   * Get the state that is reached by reading a character in the given state.
+   *
+   * @param state the state to read the character in
+   * @param character the character to read
+   * @return the state that is reached
+   */
+  [[nodiscard]] int step(int state, char character) const {
+    return m_goto[state * m_classes
+                  + m_class_of[static_cast<unsigned char>(character)]];
+  }
+};
+
+#endif
@@ -0,0 +1,140 @@
+/**
+ * This file contains the definition of the BatchMatcher class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_BATCHMATCHER_H
+#define REGEXP_BATCHMATCHER_H
+
+#include "BufferedWriter.h"
+#include "Dfa.h"
+#include "RegularExpression.h"
+#include "WorkStealingScheduler.h"
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+class BatchMatcher {
+public:
+  /**
+   * The preferred size of a chunk of lines in bytes.
+   */
+  static constexpr std::size_t CHUNK_SIZE{1 << 16};
+
+  /**
+   * The minimum size of a part of a line that is split over several tasks.
+   */
+  static constexpr std::size_t PART_SIZE{1 << 20};
+
+  /**
+   * Construct a batch matcher for the given regular expression.
+   *
+   * @param expression the regular expression to match against (not owned)
+   */
+  explicit BatchMatcher(const RegularExpression& expression);
+
+  /**
+   * Match every line of the given newline-delimited input against the regular
+   * expression and write "match" or "no match" for each line to the output.
+   *
+   * A trailing carriage return is not considered part of a line and a final
+   * line without a terminating newline is matched as well.
+   *
+   * With more than one thread, the input is split into line-aligned chunks
+   * that are matched concurrently by a work-stealing scheduler, each thread
+   * using its own scratch buffers. A line longer than a chunk forms a chunk of
+   * its own, so it cannot hold up the lines around it. If the regular
+   * expression has a DFA, such a line is split into parts as well: the parts
+   * are read concurrently and their state transfer functions are composed in
+   * order afterwards. The results are written in the order of the input
+   * regardless.
+   *
+   * @param input the newline-delimited input
+   * @param output the writer to write the results to
+   * @param threads the number of threads to match with
+   * @return the number of lines that were matched
+   */
+  std::size_t run(std::string_view input, BufferedWriter& output,
+                  unsigned threads = 1);
+
+  /**
+   * Get the statistics of every worker during the last multi-threaded run.
+   *
+   * @return the statistics per worker, empty if no such run took place
+   */
+  [[nodiscard]] const std::vector<WorkStealingScheduler::WorkerStatistics>&
+  statistics() const;
+
+private:
+  /**
+   * A task of a multi-threaded run: either the lines of a whole chunk, or a
+   * part of the single line of an oversized chunk.
+   */
+  struct Task {
+    /**
+     * What the task reads.
+     */
+    enum class Kind { LINES, FIRST_PART, NEXT_PART };
+
+    Kind kind;
+    std::size_t chunk;
+    std::string_view input;
+  };
+
+  /**
+   * The statistics of every worker during the last multi-threaded run.
+   */
+  std::vector<WorkStealingScheduler::WorkerStatistics> m_statistics{};
+
+  /**
+   * Split the input into chunks of at most the given size that each end
+   * directly after a newline (or at the end of the input). A line that does not
+   * fit in a chunk on its own forms a chunk by itself.
+   *
+   * @param input the newline-delimited input
+   * @param chunk_size the preferred size of a chunk in bytes
+   * @return the chunks in the order of the input
+   */
+  static std::vector<std::string_view> split(std::string_view input,
+                                             std::size_t chunk_size);
+
+  /**
+   * Create the tasks of a multi-threaded run. The single line of a chunk larger
+   * than CHUNK_SIZE is split into parts if a DFA is given.
+   *
+   * @param chunks the chunks of the input
+   * @param dfa the DFA to read the parts of a line with, or nullptr
+   * @param threads the number of threads to match with
+   * @return the tasks in the order of the input
+   */
+  static std::vector<Task> plan(const std::vector<std::string_view>& chunks,
+                                const Dfa* dfa, unsigned threads);
+
+  /**
+   * Match every line of a chunk, storing 1 for a match and 0 otherwise.
+   *
+   * @param chunk the newline-delimited chunk to match
+   * @param scratch the scratch buffers of the calling thread
+   * @param results the vector to append the results to
+   */
+  void matchChunk(std::string_view chunk, RegularExpression::Scratch& scratch,
+                  std::vector<char>& results) const;
+
+  /**
+   * Get the next line of the input and remove it from the input.
+   *
+   * @param input the remaining newline-delimited input
+   * @return the next line without its newline or carriage return
+   */
+  static std::string_view nextLine(std::string_view& input);
+
+  /**
+   * The regular expression to match against.
+   */
+  const RegularExpression& m_expression;
+};
+
+#endif
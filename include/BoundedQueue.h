@@ -0,0 +1,238 @@
+/**
+ * This file contains the definition and implementation of the BoundedQueue
+ * class template.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_BOUNDEDQUEUE_H
+#define REGEXP_BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+/**
+ * A lock-free first-in first-out queue of fixed capacity, which any number of
+ * threads can push to and pop from at once.
+ *
+ * Every cell carries a sequence number telling whether it is ready to be
+ * written or read in the current lap around the ring, so pushing and popping
+ * only take a single compare-and-swap on the shared position. A full queue
+ * makes pushing threads wait, which bounds the memory a fast producer can use.
+ * A waiting thread first retries for a short while, as the queue is usually
+ * drained or refilled quickly, and then blocks until it is woken up. Only
+ * threads that find others blocked pay for waking them up.
+ *
+ * @tparam T the type of the elements, which must be default-constructible and
+ *           movable
+ */
+template <typename T>
+class BoundedQueue {
+public:
+  /**
+   * The number of times a waiting thread retries before it blocks.
+   */
+  static constexpr int SPIN_TRIES{64};
+
+  /**
+   * Construct an empty queue.
+   *
+   * @param capacity the number of elements the queue can hold, rounded up to a
+   *                 power of two
+   */
+  explicit BoundedQueue(std::size_t capacity) {
+    std::size_t size{2};
+    while (size < capacity) {
+      size *= 2;
+    }
+    m_cells = std::make_unique<Cell[]>(size);
+    m_mask = size - 1;
+    for (std::size_t index{0}; index < size; ++index) {
+      m_cells[index].sequence.store(index, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Append an element, unless the queue is full.
+   *
+   * @param value the element, which is moved from on success
+   * @return true if the element was appended, false if the queue was full
+   */
+  bool tryPush(T& value) {
+    std::size_t position{m_push_position.load(std::memory_order_relaxed)};
+    while (true) {
+      Cell& cell{m_cells[position & m_mask]};
+      std::size_t sequence{cell.sequence.load(std::memory_order_acquire)};
+      auto difference{static_cast<std::ptrdiff_t>(sequence - position)};
+      if (difference == 0) {
+        if (m_push_position.compare_exchange_weak(position, position + 1,
+                                                  std::memory_order_relaxed)) {
+          cell.value = std::move(value);
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false; // The cell still holds an element of the previous lap
+      } else {
+        position = m_push_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Take the first element, unless the queue is empty.
+   *
+   * @param value the element that was taken, if any
+   * @return true if an element was taken, false if the queue was empty
+   */
+  bool tryPop(T& value) {
+    std::size_t position{m_pop_position.load(std::memory_order_relaxed)};
+    while (true) {
+      Cell& cell{m_cells[position & m_mask]};
+      std::size_t sequence{cell.sequence.load(std::memory_order_acquire)};
+      auto difference{static_cast<std::ptrdiff_t>(sequence - (position + 1))};
+      if (difference == 0) {
+        if (m_pop_position.compare_exchange_weak(position, position + 1,
+                                                 std::memory_order_relaxed)) {
+          value = std::move(cell.value);
+          cell.sequence.store(position + m_mask + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false; // The cell has not been written in this lap yet
+      } else {
+        position = m_pop_position.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Append an element, waiting for room if the queue is full.
+   *
+   * @param value the element
+   */
+  void push(T value) {
+    wait([&] { return tryPush(value); }, m_push_waiters, m_not_full);
+    wake(m_pop_waiters, m_not_empty);
+  }
+
+  /**
+   * Take the first element, waiting for one if the queue is empty.
+   *
+   * @return the element
+   */
+  T pop() {
+    T value{};
+    wait([&] { return tryPop(value); }, m_pop_waiters, m_not_empty);
+    wake(m_push_waiters, m_not_full);
+    return value;
+  }
+
+private:
+  /**
+   * Retry an operation until it succeeds, blocking on a condition variable
+   * once spinning has not helped.
+   *
+   * @tparam Operation the type of the operation
+   * @param operation the operation, returning true once it has succeeded
+   * @param waiters the number of threads blocked on the condition variable
+   * @param condition the condition variable to block on
+   */
+  template <typename Operation>
+  void wait(Operation operation, std::atomic<int>& waiters,
+            std::condition_variable& condition) {
+    for (int tries{0}; tries < SPIN_TRIES; ++tries) {
+      if (operation()) {
+        return;
+      }
+      std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock{m_mutex};
+    waiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with wake()
+    while (!operation()) {
+      condition.wait(lock);
+    }
+    waiters.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Wake up the threads blocked on a condition variable, if there are any.
+   *
+   * @param waiters the number of threads blocked on the condition variable
+   * @param condition the condition variable they are blocked on
+   */
+  void wake(std::atomic<int>& waiters, std::condition_variable& condition) {
+    // Either a thread about to block sees the operation that just completed,
+    // or its waiter count is seen here
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      condition.notify_all();
+    }
+  }
+
+  /**
+   * A slot of the ring.
+   */
+  struct Cell {
+    std::atomic<std::size_t> sequence{0};
+    T value{};
+  };
+
+  /**
+   * The slots of the ring.
+   */
+  std::unique_ptr<Cell[]> m_cells{};
+
+  /**
+   * The number of slots minus one, to wrap positions around the ring.
+   */
+  std::size_t m_mask{0};
+
+  /**
+   * The number of elements pushed so far, kept on its own cache line so
+   * producers and consumers do not contend for it.
+   */
+  alignas(64) std::atomic<std::size_t> m_push_position{0};
+
+  /**
+   * The number of elements popped so far.
+   */
+  alignas(64) std::atomic<std::size_t> m_pop_position{0};
+
+  /**
+   * The number of threads blocked until the queue is no longer full.
+   */
+  alignas(64) std::atomic<int> m_push_waiters{0};
+
+  /**
+   * The number of threads blocked until the queue is no longer empty.
+   */
+  std::atomic<int> m_pop_waiters{0};
+
+  /**
+   * The mutex guarding the condition variables.
+   */
+  std::mutex m_mutex{};
+
+  /**
+   * Signalled when an element was taken while pushing threads were blocked.
+   */
+  std::condition_variable m_not_full{};
+
+  /**
+   * Signalled when an element was appended while popping threads were blocked.
+   */
+  std::condition_variable m_not_empty{};
+};
+
+#endif
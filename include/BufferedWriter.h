@@ -0,0 +1,66 @@
+/**
+ * This file contains the definition of the BufferedWriter class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_BUFFEREDWRITER_H
+#define REGEXP_BUFFEREDWRITER_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+class BufferedWriter {
+public:
+  /**
+   * Construct a writer that collects output in a buffer of the given capacity
+   * and hands it to the given file descriptor whenever the buffer is full.
+   *
+   * @param descriptor the file descriptor to write to (not owned)
+   * @param capacity the size of the buffer in bytes
+   */
+  explicit BufferedWriter(int descriptor, std::size_t capacity = 1 << 20);
+
+  BufferedWriter(const BufferedWriter&) = delete;
+  BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+  /**
+   * Flush the remaining buffered output.
+   */
+  ~BufferedWriter();
+
+  /**
+   * Append a string to the output.
+   *
+   * @param string the string to append
+   */
+  void write(std::string_view string);
+
+  /**
+   * Write all buffered output to the file descriptor.
+   *
+   * @throws std::system_error if writing fails
+   */
+  void flush();
+
+private:
+  /**
+   * The file descriptor the output is written to.
+   */
+  int m_descriptor;
+
+  /**
+   * The buffer holding output that has not been written yet.
+   */
+  std::vector<char> m_buffer;
+
+  /**
+   * The number of bytes in use at the front of the buffer.
+   */
+  std::size_t m_used{0};
+};
+
+#endif
@@ -0,0 +1,146 @@
+/**
+ * This file contains the definition of the CommandPipeline class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_COMMANDPIPELINE_H
+#define REGEXP_COMMANDPIPELINE_H
+
+#include "BoundedQueue.h"
+#include "RegularExpression.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Executes a script of exp and mat commands, as given to the program in
+ * autonomous mode, in three stages running at the same time:
+ *
+ * 1. Parsing reads the script in large blocks, splits it into commands and
+ *    compiles the regular expressions of exp commands, grouping the mat
+ *    commands into batches.
+ * 2. Matching checks the strings of a batch and formats the results, on
+ *    several threads that each take the next batch that is ready.
+ * 3. Writing puts the formatted batches back in order and writes them out.
+ *
+ * The stages hand batches to each other through bounded lock-free queues, so
+ * a slow stage makes the earlier ones wait instead of buffering the script.
+ */
+class CommandPipeline {
+public:
+  /**
+   * The maximum number of commands in a batch.
+   */
+  static constexpr std::size_t BATCH_COMMANDS{4096};
+
+  /**
+   * Construct a pipeline matching with the given number of threads.
+   *
+   * @param threads the number of threads of the matching stage, at least one
+   *                is used
+   */
+  explicit CommandPipeline(unsigned threads);
+
+  /**
+   * Execute the script read from the input until it ends or an end command is
+   * read, writing the results to the output.
+   *
+   * @param input the file descriptor to read the script from
+   * @param output the file descriptor to write the results to
+   * @throws std::system_error if reading or writing fails, or if a thread
+   *         cannot be started, once the threads that did start have stopped
+   * @throws std::bad_alloc if memory runs out while parsing or matching
+   */
+  void run(int input, int output);
+
+private:
+  /**
+   * A single command of a batch, producing a line of output.
+   */
+  struct Command {
+    /**
+     * The text written before the result, e.g. a prompt.
+     */
+    std::string_view prefix{};
+
+    /**
+     * The index in the expressions of the batch of the regular expression to
+     * match against, or -1 if the command does not match.
+     */
+    int expression = -1;
+
+    /**
+     * The string to match, or to write after the prefix if not matching.
+     */
+    std::string_view string{};
+  };
+
+  /**
+   * A group of consecutive commands passed between the stages.
+   */
+  struct Batch {
+    /**
+     * The position of the batch in the script.
+     */
+    std::size_t sequence = 0;
+
+    /**
+     * The block of the script the commands refer to, shared by every batch
+     * made from it.
+     */
+    std::shared_ptr<const std::string> text{};
+
+    /**
+     * The regular expressions the commands match against.
+     */
+    std::vector<std::shared_ptr<const RegularExpression>> expressions{};
+
+    /**
+     * The commands, in order.
+     */
+    std::vector<Command> commands{};
+
+    /**
+     * The formatted results of the commands.
+     */
+    std::string output{};
+  };
+
+  /**
+   * The number of threads of the matching stage.
+   */
+  unsigned m_threads;
+
+  /**
+   * The batches waiting to be matched. A null batch tells a matching thread
+   * to stop.
+   */
+  BoundedQueue<std::unique_ptr<Batch>> m_parsed;
+
+  /**
+   * The batches waiting to be written. A null batch tells that a matching
+   * thread stopped.
+   */
+  BoundedQueue<std::unique_ptr<Batch>> m_matched;
+
+  /**
+   * Run the parsing stage, handing every batch to the matching stage and
+   * finally a stop request for every matching thread.
+   *
+   * @param input the file descriptor to read the script from
+   * @throws std::system_error if reading fails
+   */
+  void parse(int input);
+
+  /**
+   * Run a thread of the matching stage until it is told to stop.
+   */
+  void match();
+};
+
+#endif
@@ -0,0 +1,215 @@
+/**
+ * This file contains the definition of the Dfa class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_DFA_H
+#define REGEXP_DFA_H
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+class RegularExpression;
+
+class Dfa {
+public:
+  /**
+   * The state that is reached once no continuation can be accepted anymore.
+   * It is never accepting and every transition leads back to it.
+   */
+  static constexpr int DEAD_STATE{0};
+
+  /**
+   * The default maximum number of states of a DFA.
+   */
+  static constexpr std::size_t DEFAULT_STATE_LIMIT{1024};
+
+  /**
+   * Derive a DFA from the automaton of a regular expression by means of the
+   * subset construction.
+   *
+   * @param expression the regular expression to derive the DFA from
+   * @param state_limit the maximum number of states the DFA may have
+   * @return the DFA, or nothing if it would exceed the state limit or the
+   *         regular expression has no automaton
+   */
+  static std::optional<Dfa> build(const RegularExpression& expression,
+                                  std::size_t state_limit = DEFAULT_STATE_LIMIT);
+
+  /**
+   * Get the initial state of the DFA.
+   *
+   * @return the initial state
+   */
+  [[nodiscard]] int initialState() const { return m_initial_state; }
+
+  /**
+   * Get the number of states of the DFA, including the dead state.
+   *
+   * @return the number of states
+   */
+  [[nodiscard]] std::size_t size() const { return m_tag_set_of.size(); }
+
+  /**
+   * Check whether a state is accepting.
+   *
+   * @param state the state to check
+   * @return true if the state is accepting, false otherwise
+   */
+  [[nodiscard]] bool accepting(int state) const {
+    return m_tag_set_of[state] != 0;
+  }
+
+  /**
+   * Get the tags of the final NFA states contained in a state, where the tag of
+   * a final state is its position among the final states of the NFA.
+   *
+   * @param state the state to get the tags of
+   * @return the tags in ascending order, empty if the state is not accepting
+   */
+  [[nodiscard]] const std::vector<int>& tags(int state) const {
+    return m_tag_sets[m_tag_set_of[state]];
+  }
+
+  /**
+   * Get the state that is reached by reading a character in the given state.
+   *
+   * @param state the state to read the character in
+   * @param character the character to read
+   * @return the state that is reached
+   */
+  [[nodiscard]] int step(int state, unsigned char character) const {
+    return m_transitions[state * m_classes + m_class_of[character]];
+  }
+
+  /**
+   * Get the state that is reached by reading a string in the given state.
+   * Reading stops as soon as the dead state is reached.
+   *
+   * @param state the state to start reading in
+   * @param string the string to read
+   * @return the state that is reached
+   */
+  [[nodiscard]] int run(int state, std::string_view string) const;
+
+  /**
+   * Get the state transfer function of a string: for every state, the state
+   * that is reached by reading the string in that state.
+   *
+   * All states are run simultaneously. Runs that reach the same state are
+   * merged along the way, so in practice the cost quickly approaches that of a
+   * single run.
+   *
+   * @param string the string to read
+   * @return for every state, the state that is reached
+   */
+  [[nodiscard]] std::vector<int> transfer(std::string_view string) const;
+
+  /**
+   * Read many strings from the initial state, storing for every string the
+   * state that is reached.
+   *
+   * Eight strings are read in lockstep: every iteration advances each of them
+   * by one transition, and a string that has been read completely is replaced
+   * by the next one. As the transitions of different strings do not depend on
+   * each other, their table loads are in flight at the same time. On CPUs
+   * supporting AVX2, the loads are performed by gather instructions. A string
+   * that reaches the dead state is replaced early as well.
+   *
+   * @param strings the strings to read
+   * @param count the number of strings
+   * @param states the array to store the reached state of every string in
+   */
+  void runBatch(const std::string_view* strings, std::size_t count,
+                int* states) const;
+
+private:
+  /**
+   * Construct an empty DFA, to be filled in by build().
+   */
+  Dfa() = default;
+
+  /**
+   * For every character, the class of characters it belongs to. Characters
+   * that do not occur in the regular expression share class 0.
+   */
+  std::array<int, 256> m_class_of{};
+
+  /**
+   * The number of character classes.
+   */
+  int m_classes{1};
+
+  /**
+   * The transition table, indexed by state * m_classes + class.
+   */
+  std::vector<int> m_transitions{};
+
+  /**
+   * For every state, the index of its set of tags in m_tag_sets.
+   */
+  std::vector<int> m_tag_set_of{};
+
+  /**
+   * The distinct sets of tags of the states, where set 0 is the empty set.
+   */
+  std::vector<std::vector<int>> m_tag_sets{{}};
+
+  /**
+   * The initial state of the DFA.
+   */
+  int m_initial_state{DEAD_STATE};
+
+  /**
+   * Whether runBatch() may use AVX2 instructions.
+   */
+  bool m_avx2{false};
+
+  /**
+   * The number of strings runBatch() reads in lockstep.
+   */
+  static constexpr std::size_t LANES{8};
+
+  /**
+   * Implementation of runBatch(): keeps every lane supplied with a string and
+   * stores the reached states, while a kernel performs the transitions.
+   *
+   * @tparam Kernel the type of the kernel
+   * @param strings the strings to read
+   * @param count the number of strings
+   * @param states the array to store the reached state of every string in
+   * @param kernel the kernel, called like stepLanes()
+   */
+  template <typename Kernel>
+  void runLanes(const std::string_view* strings, std::size_t count,
+                int* states, Kernel kernel) const;
+
+  /**
+   * Advance every lane by the given number of transitions using scalar loads.
+   *
+   * @param positions the position in the string of every lane
+   * @param steps the number of characters to read in every lane
+   * @param lane_states the state of every lane, aligned to 32 bytes
+   */
+  void stepLanes(const char* const* positions, std::size_t steps,
+                 int* lane_states) const;
+
+  /**
+   * Advance every lane by the given number of transitions using AVX2 gather
+   * instructions.
+   *
+   * @param positions the position in the string of every lane
+   * @param steps the number of characters to read in every lane
+   * @param lane_states the state of every lane, aligned to 32 bytes
+   */
+  void stepLanesAvx2(const char* const* positions, std::size_t steps,
+                     int* lane_states) const;
+};
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * This file contains the definition of the GraphExporter class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_GRAPHEXPORTER_H
+#define REGEXP_GRAPHEXPORTER_H
+
+#include "RegularExpression.h"
+#include <cstddef>
+
+/**
+ * Writes the automaton of a regular expression to a file descriptor, for
+ * automata too large to export comfortably through RegularExpression::dot().
+ */
+class GraphExporter {
+public:
+  /**
+   * The number of states formatted as a single task.
+   */
+  static constexpr std::size_t CHUNK_STATES{1 << 14};
+
+  /**
+   * Construct an exporter for the automaton of a regular expression.
+   *
+   * @param expression the regular expression, which must outlive the exporter
+   */
+  explicit GraphExporter(const RegularExpression& expression);
+
+  /**
+   * Write the dot notation of the automaton, as RegularExpression::dot()
+   * does.
+   *
+   * The states are split into chunks that the given number of threads format
+   * into buffers of their own. The buffers are written in order once a round
+   * of chunks is formatted, so only a few chunks per thread are held in memory
+   * at once.
+   *
+   * @param descriptor the file descriptor to write to
+   * @param threads the number of threads to format with
+   * @throws std::system_error if writing fails
+   */
+  void dot(int descriptor, unsigned threads = 1) const;
+
+  /**
+   * Write the dot notation of the region of the automaton around a state:
+   * every state reachable from it in at most the given number of edges, and
+   * the edges leaving the states that are closer than that. The time taken
+   * is proportional to the size of the region, not of the automaton.
+   *
+   * @param descriptor the file descriptor to write to
+   * @param state the state to start from, numbered as in the dot notation
+   *              (from 1), which must exist
+   * @param depth the maximum number of edges between the state and the
+   *              states of the region
+   * @throws std::system_error if writing fails
+   */
+  void region(int descriptor, int state, std::size_t depth) const;
+
+  /**
+   * Write the automaton as a compact binary edge list. All integers are
+   * little-endian; states are numbered from 0 as in the automaton itself.
+   *
+   * - The magic bytes "RXEL" and the format version (uint32, 1).
+   * - The number of states, the initial state and the number of final states
+   *   (uint32 each), followed by every final state (uint32).
+   * - The number of edges (uint64), followed by every edge as its source and
+   *   target state (uint32 each) and its label (uint8: the character, or 0
+   *   for an empty transition).
+   *
+   * @param descriptor the file descriptor to write to
+   * @throws std::system_error if writing fails
+   */
+  void binary(int descriptor) const;
+
+  /**
+   * Write the automaton as JSON, with the outgoing edges of every state in an
+   * adjacency list. States are numbered from 0 as in the automaton itself,
+   * and empty transitions are labelled null:
+   *
+   * {"states": 3, "initial": 0, "final": [2],
+   *  "adjacency": [[[1, "a"]], [[2, null]], []]}
+   *
+   * @param descriptor the file descriptor to write to
+   * @throws std::system_error if writing fails
+   */
+  void json(int descriptor) const;
+
+private:
+  /**
+   * The regular expression whose automaton is exported.
+   */
+  const RegularExpression& m_expression;
+};
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ * This file contains the definition of the MappedFile class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_MAPPEDFILE_H
+#define REGEXP_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class MappedFile {
+public:
+  /**
+   * Map the file at the given path read-only into memory.
+   *
+   * @param path the path of the file to map
+   * @throws std::system_error if the file cannot be opened or mapped
+   */
+  explicit MappedFile(const std::string& path);
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * Unmap the file.
+   */
+  ~MappedFile();
+
+  /**
+   * Get the contents of the mapped file.
+   *
+   * @return a view over the complete contents of the file
+   */
+  [[nodiscard]] std::string_view contents() const;
+
+private:
+  /**
+   * The start of the mapping, nullptr if the file is empty.
+   */
+  const char* m_data{nullptr};
+
+  /**
+   * The size of the mapping in bytes.
+   */
+  std::size_t m_size{0};
+};
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * This file contains the definition of the MatchClient class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_MATCHCLIENT_H
+#define REGEXP_MATCHCLIENT_H
+
+#include "MatchServer.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * A client of a MatchServer, sending a request and waiting for its response
+ * one at a time.
+ */
+class MatchClient {
+public:
+  /**
+   * Connect to the server listening on the socket at the given path.
+   *
+   * @param path the path of the socket
+   * @throws std::system_error if the server cannot be reached
+   */
+  explicit MatchClient(const std::string& path);
+
+  MatchClient(const MatchClient&) = delete;
+  MatchClient& operator=(const MatchClient&) = delete;
+
+  /**
+   * Disconnect from the server.
+   */
+  ~MatchClient();
+
+  /**
+   * Have the server compile a regular expression.
+   *
+   * @param expression the regular expression to compile
+   * @return the id of the compiled regular expression
+   * @throws std::system_error if the server cannot be reached or refuses
+   */
+  std::uint32_t compile(std::string_view expression);
+
+  /**
+   * Have the server check if the given string is accepted by a compiled
+   * regular expression.
+   *
+   * @param id the id of the compiled regular expression
+   * @param string the string to check
+   * @return true if the string matches, false otherwise
+   * @throws std::system_error if the server cannot be reached or refuses
+   */
+  bool match(std::uint32_t id, std::string_view string);
+
+  /**
+   * Have the server check for every given string if it is accepted by a
+   * compiled regular expression, in a single request.
+   *
+   * @param id the id of the compiled regular expression
+   * @param strings the strings to check
+   * @param results the vector to append 1 (match) or 0 (no match) to for every
+   *                string
+   * @throws std::system_error if the server cannot be reached or refuses
+   */
+  void matchBatch(std::uint32_t id, const std::vector<std::string_view>& strings,
+                  std::vector<char>& results);
+
+  /**
+   * Have the server forget a compiled regular expression.
+   *
+   * @param id the id of the compiled regular expression
+   * @throws std::system_error if the server cannot be reached or refuses
+   */
+  void release(std::uint32_t id);
+
+private:
+  /**
+   * The socket connected to the server.
+   */
+  int m_socket{-1};
+
+  /**
+   * The request being built, or the response that was received last.
+   */
+  std::vector<char> m_buffer{};
+
+  /**
+   * Start building a request in the buffer.
+   *
+   * @param request the kind of request
+   */
+  void start(MatchServer::Request request);
+
+  /**
+   * Send the request in the buffer, filling in its length, and replace it by
+   * the payload of the response.
+   *
+   * @return the response payload after the status byte
+   * @throws std::system_error if the server cannot be reached or refuses
+   */
+  std::string_view exchange();
+};
+
+#endif
@@ -0,0 +1,211 @@
+/**
+ * This file contains the definition of the MatchServer class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_MATCHSERVER_H
+#define REGEXP_MATCHSERVER_H
+
+#include "RegularExpression.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * A server keeping compiled regular expressions resident, which local clients
+ * talk to over a Unix domain socket.
+ *
+ * Every request and response is a frame: a 32-bit length followed by that many
+ * bytes of payload. Integers are 32-bit and in host byte order, as both ends
+ * run on the same machine. A request payload starts with a Request byte:
+ *
+ * - COMPILE: the expression. Answered with the id of the compiled expression,
+ *   which is only known on the connection that compiled it.
+ * - MATCH: the id, then the string. Answered with a byte that is 1 if the
+ *   string matches and 0 otherwise.
+ * - MATCH_BATCH: the id, the number of strings and every string as its length
+ *   followed by its bytes. Answered with the number of strings and a byte per
+ *   string as for MATCH.
+ * - RELEASE: the id. Answered with nothing but the status.
+ *
+ * A response payload starts with a Status byte, followed by the answer if the
+ * status is OK. As with the mat command, the string "$" stands for the empty
+ * string.
+ *
+ * All clients are served by a single thread, so a large batch or a long string
+ * holds up the requests of every other client until it has been matched.
+ * Clients needing more throughput can spread their work over several servers.
+ */
+class MatchServer {
+public:
+  /**
+   * The kinds of requests.
+   */
+  enum class Request : std::uint8_t {
+    COMPILE = 1,
+    MATCH = 2,
+    MATCH_BATCH = 3,
+    RELEASE = 4
+  };
+
+  /**
+   * The outcomes of requests.
+   */
+  enum class Status : std::uint8_t {
+    OK = 0,
+    UNKNOWN_EXPRESSION = 1,
+    MALFORMED_REQUEST = 2,
+    FAILED = 3 // E.g. the server ran out of memory
+  };
+
+  /**
+   * The largest frame payload that is accepted. A client sending a larger
+   * frame is disconnected.
+   */
+  static constexpr std::uint32_t MAX_FRAME{64U << 20};
+
+  /**
+   * Create a socket at the given path and start listening on it. A socket
+   * left behind at the path by a server that is no longer running is
+   * replaced.
+   *
+   * @param path the path of the socket
+   * @throws std::system_error if the socket cannot be set up, e.g. because
+   *         another server is listening on it
+   */
+  explicit MatchServer(std::string path);
+
+  MatchServer(const MatchServer&) = delete;
+  MatchServer& operator=(const MatchServer&) = delete;
+
+  /**
+   * Disconnect every client and remove the socket.
+   */
+  ~MatchServer();
+
+  /**
+   * Serve clients until an unrecoverable error occurs. Clients are served
+   * concurrently by a single thread waiting on all of their sockets at once.
+   * A client whose connection cannot be kept up, e.g. because memory ran out
+   * while receiving its requests, is disconnected without affecting the
+   * others.
+   *
+   * @throws std::system_error if waiting for or accepting clients fails
+   */
+  void run();
+
+private:
+  /**
+   * A connected client.
+   */
+  struct Connection {
+    /**
+     * The received bytes that do not form a complete frame yet.
+     */
+    std::vector<char> input{};
+
+    /**
+     * The response bytes that have not been sent yet.
+     */
+    std::vector<char> output{};
+
+    /**
+     * The number of bytes at the front of the output that have been sent.
+     */
+    std::size_t sent{0};
+
+    /**
+     * The regular expressions compiled by the client, by id.
+     */
+    std::unordered_map<std::uint32_t, RegularExpression> expressions{};
+
+    /**
+     * The id to give the next regular expression compiled by the client.
+     */
+    std::uint32_t next_id{1};
+  };
+
+  /**
+   * The path of the socket.
+   */
+  std::string m_path;
+
+  /**
+   * The socket accepting clients.
+   */
+  int m_listener{-1};
+
+  /**
+   * The epoll instance waiting on the listener and every client.
+   */
+  int m_epoll{-1};
+
+  /**
+   * The connected clients, by socket.
+   */
+  std::unordered_map<int, Connection> m_connections{};
+
+  /**
+   * The scratch buffers used for matching, shared by all clients since they
+   * are served by a single thread.
+   */
+  RegularExpression::Scratch m_scratch{};
+
+  /**
+   * The strings of the batch being matched.
+   */
+  std::vector<std::string_view> m_batch{};
+
+  /**
+   * The results of the batch being matched.
+   */
+  std::vector<char> m_results{};
+
+  /**
+   * Accept every client that is waiting to connect.
+   */
+  void accept();
+
+  /**
+   * Read what a client sent and answer every complete request.
+   *
+   * @param client the socket of the client
+   * @param connection the state of the client
+   * @return false if the client should be disconnected, true otherwise
+   */
+  bool receive(int client, Connection& connection);
+
+  /**
+   * Send as much of the pending responses to a client as its socket takes,
+   * waiting for the socket to become writable if anything remains.
+   *
+   * @param client the socket of the client
+   * @param connection the state of the client
+   * @return false if the client should be disconnected, true otherwise
+   */
+  bool send(int client, Connection& connection);
+
+  /**
+   * Answer a single request. A request that fails, e.g. because memory ran
+   * out, is answered with Status::FAILED.
+   *
+   * @param request the payload of the request frame
+   * @param connection the state of the client that sent the request
+   */
+  void answer(std::string_view request, Connection& connection);
+
+  /**
+   * Stop serving a client.
+   *
+   * @param client the socket of the client
+   */
+  void disconnect(int client);
+};
+
+#endif
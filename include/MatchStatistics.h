@@ -0,0 +1,129 @@
+/**
+ * This file contains the definition of the MatchStatistics class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_MATCHSTATISTICS_H
+#define REGEXP_MATCHSTATISTICS_H
+
+#include <cstddef>
+
+/**
+ * Count matching work only when built with REGEXP_STATISTICS, so the counters
+ * cost nothing otherwise.
+ */
+#ifdef REGEXP_STATISTICS
+#define REGEXP_COUNT(statement) statement
+#else
+#define REGEXP_COUNT(statement)
+#endif
+
+class MatchStatistics {
+public:
+  /**
+   * Whether the counters are updated by this build.
+   */
+  static constexpr bool ENABLED{
+#ifdef REGEXP_STATISTICS
+      true
+#else
+      false
+#endif
+  };
+
+  /**
+   * The number of strings matched by the Aho-Corasick automaton.
+   */
+  std::size_t literal_matches{0};
+
+  /**
+   * The number of strings matched by the DFA.
+   */
+  std::size_t dfa_matches{0};
+
+  /**
+   * The number of strings matched by simulating the NFA: those read before
+   * enough bytes were simulated to derive the DFA, and all strings of
+   * expressions whose DFA would exceed the state limit.
+   */
+  std::size_t nfa_matches{0};
+
+  /**
+   * The number of strings among the NFA matches that were simulated because
+   * the DFA had not been derived yet.
+   */
+  std::size_t dfa_deferrals{0};
+
+  /**
+   * The number of DFAs derived on first use, whether or not they stayed within
+   * the state limit. Every other DFA match reused a DFA derived earlier.
+   */
+  std::size_t dfa_builds{0};
+
+  /**
+   * The number of characters of the matched strings.
+   */
+  std::size_t characters{0};
+
+  /**
+   * The number of states made active while simulating the NFA.
+   */
+  std::size_t states_visited{0};
+
+  /**
+   * The number of active state lists (closures) built while simulating the
+   * NFA: one for the start and one per character read.
+   */
+  std::size_t closures{0};
+
+  /**
+   * The largest number of states that was active at once.
+   */
+  std::size_t max_closure{0};
+
+  /**
+   * The number of buffers allocated while matching.
+   */
+  std::size_t allocations{0};
+
+  /**
+   * Record a closure of the given size.
+   *
+   * @param size the number of states in the closure
+   */
+  void closure(std::size_t size);
+
+  /**
+   * Add the counters of a single match to the totals of the process.
+   * Thread-safe, so scratch buffers of several threads can be recorded. Every
+   * thread adds to totals of its own, so threads do not wait for each other;
+   * they are only combined when the totals are requested.
+   *
+   * @param statistics the counters to add
+   */
+  static void record(const MatchStatistics& statistics);
+
+  /**
+   * Get the totals of the process.
+   *
+   * @return the counters recorded so far
+   */
+  static MatchStatistics total();
+
+  /**
+   * Add the given counters to these.
+   *
+   * @param statistics the counters to add
+   */
+  void merge(const MatchStatistics& statistics);
+
+  /**
+   * Set the totals of the process back to zero.
+   */
+  static void reset();
+};
+
+#endif
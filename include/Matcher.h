@@ -0,0 +1,79 @@
+/**
+ * This file contains the definition of the Matcher class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_MATCHER_H
+#define REGEXP_MATCHER_H
+
+#include "RegularExpression.h"
+#include <string_view>
+
+class Matcher {
+public:
+  /**
+   * Construct a matcher checking a string that is provided in chunks.
+   *
+   * Unlike mat(), the string is taken literally: "$" is not treated as the
+   * empty string.
+   *
+   * @param expression the regular expression to match against (not owned)
+   */
+  explicit Matcher(const RegularExpression& expression);
+
+  /**
+   * Read the next chunk of the string. Only the state of the automaton is
+   * carried over between chunks, and no memory is allocated.
+   *
+   * @param chunk the next chunk of the string
+   */
+  void feed(std::string_view chunk);
+
+  /**
+   * Check whether the chunks read since construction or the last call to
+   * finish() form a string accepted by the regular expression, and start
+   * over for a new string.
+   *
+   * @return true if the string matches the RegExp, false otherwise
+   */
+  bool finish();
+
+private:
+  /**
+   * The regular expression to match against.
+   */
+  const RegularExpression& m_expression;
+
+  /**
+   * The DFA of the regular expression, derived up front as a stream is usually
+   * long, or nullptr if the literals or the NFA are used instead.
+   */
+  const Dfa* m_dfa;
+
+  /**
+   * The scratch buffers holding the active states of the NFA, if neither a
+   * DFA nor the literals are available.
+   */
+  RegularExpression::Scratch m_scratch{};
+
+  /**
+   * The current state of the DFA or Aho-Corasick automaton, -1 if the
+   * Aho-Corasick automaton cannot accept anymore.
+   */
+  int m_state{};
+
+  /**
+   * Whether any characters have been read since starting over.
+   */
+  bool m_empty{true};
+
+  /**
+   * Start over for a new string.
+   */
+  void reset();
+};
+
+#endif
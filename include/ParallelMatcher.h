@@ -0,0 +1,50 @@
+/**
+ * This file contains the definition of the ParallelMatcher class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_PARALLELMATCHER_H
+#define REGEXP_PARALLELMATCHER_H
+
+#include "Dfa.h"
+#include <string_view>
+
+class ParallelMatcher {
+public:
+  /**
+   * Construct a matcher that checks single strings using multiple threads.
+   *
+   * @param dfa the DFA to match against (not owned)
+   * @param threads the number of threads to match with
+   */
+  ParallelMatcher(const Dfa& dfa, unsigned threads);
+
+  /**
+   * Check if the given string is accepted by the DFA.
+   *
+   * The string is split into chunks. The first chunk is read from the initial
+   * state, while every other chunk is read speculatively from every state to
+   * obtain its state transfer function. Composing these functions in order
+   * yields the state that is reached at the end of the string.
+   *
+   * @param string the string to check
+   * @return true if the string is accepted, false otherwise
+   */
+  [[nodiscard]] bool mat(std::string_view string) const;
+
+private:
+  /**
+   * The DFA to match against.
+   */
+  const Dfa& m_dfa;
+
+  /**
+   * The number of threads to match with.
+   */
+  unsigned m_threads;
+};
+
+#endif
@@ -9,9 +9,17 @@
 #ifndef REGEXP_REGULAREXPRESSION_H
 #define REGEXP_REGULAREXPRESSION_H
 
+#include "AhoCorasick.h"
+#include "Dfa.h"
+#include "MatchStatistics.h"
+#include <atomic>
 #include <cctype>
-#include <set>
-#include <sstream>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <ostream>
 #include <stack>
 #include <string>
 #include <string_view>
@@ -27,9 +35,18 @@ public:
   /**
    * Construct an automaton representing a regular expression from a string.
    *
+   * The states are written into the automaton as they are parsed. The
+   * bookkeeping of the parser is allocated from a monotonic arena that starts
+   * out on the stack and is released at once when construction ends, so
+   * parsing a short expression only allocates the automaton itself.
+   *
    * @param expression the string to construct the regular expression from
+   * @param resource the memory resource the arena takes more memory from once
+   *                 its stack buffer is used up
    */
-  explicit RegularExpression(std::string_view expression);
+  explicit RegularExpression(
+      std::string_view expression,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
   /**
    * Get the dot notation of the automaton representing the regular expression.
@@ -38,6 +55,16 @@ public:
    */
   [[nodiscard]] std::string dot() const;
 
+  /**
+   * Write the dot notation of the automaton representing the regular
+   * expression to a stream. The edges are formatted into a fixed-size buffer
+   * that is handed to the stream whenever it fills up, so the notation is
+   * never held in memory as a whole.
+   *
+   * @param output the stream to write to
+   */
+  void dot(std::ostream& output) const;
+
   /**
    * Check if the given string is accepted by the regular expression.
    *
@@ -46,7 +73,161 @@ public:
    */
   [[nodiscard]] bool mat(std::string_view string) const;
 
+  /**
+   * Scratch buffers used while matching a string against the automaton.
+   *
+   * Matching never modifies the RegularExpression itself, so a single instance
+   * can be shared between threads as long as every thread brings its own
+   * Scratch. Reusing a Scratch across calls avoids allocating per match.
+   */
+  class Scratch {
+  private:
+    friend class Dfa;
+    friend class Matcher;
+    friend class RegularExpression;
+    friend class RegularExpressionSet;
+
+    /**
+     * The states that are active before the current character.
+     */
+    std::vector<int> m_current_states{};
+
+    /**
+     * The states that are active after the current character.
+     */
+    std::vector<int> m_next_states{};
+
+    /**
+     * The states that still have to be traversed by the epsilon closure.
+     */
+    std::vector<int> m_pending_states{};
+
+    /**
+     * For every state, the generation in which it was last made active.
+     */
+    std::vector<unsigned> m_marks{};
+
+    /**
+     * The generation of the state list that is currently being built.
+     */
+    unsigned m_generation{0};
+
+    /**
+     * The strings of a batch, as they are to be read by the DFA.
+     */
+    std::vector<std::string_view> m_batch_strings{};
+
+    /**
+     * The DFA states reached by the strings of a batch.
+     */
+    std::vector<int> m_batch_states{};
+
+#ifdef REGEXP_STATISTICS
+    /**
+     * The work counted since these buffers were last recorded.
+     */
+    MatchStatistics m_statistics{};
+#endif
+  };
+
+  /**
+   * Check if the given string is accepted by the regular expression, using the
+   * given scratch buffers instead of allocating new ones.
+   *
+   * @param string the string to check
+   * @param scratch the scratch buffers to use, owned by the calling thread
+   * @return true if the string matches the RegExp, false otherwise
+   */
+  [[nodiscard]] bool mat(std::string_view string, Scratch& scratch) const;
+
+  /**
+   * Check for every given string whether it is accepted by the regular
+   * expression.
+   *
+   * When a DFA is available, the strings are read in lockstep (see
+   * Dfa::runBatch()), which hides the latency of the transition table loads
+   * better than checking the strings one after another.
+   *
+   * @param strings the strings to check
+   * @param scratch the scratch buffers to use, owned by the calling thread
+   * @param results the vector to append 1 (match) or 0 (no match) to for every
+   *                string
+   */
+  void matBatch(const std::vector<std::string_view>& strings, Scratch& scratch,
+                std::vector<char>& results) const;
+
+  /**
+   * Get the number of states of the automaton representing the regular
+   * expression.
+   *
+   * @return the number of states
+   */
+  [[nodiscard]] std::size_t states() const;
+
+  /**
+   * Get the DFA derived from the automaton, which is used for matching when
+   * available. The DFA is only derived when it is first asked for, as the
+   * subset construction may cost far more than parsing, and may even be given
+   * up on. Matching many or long strings asks for it; mat() only does so once
+   * enough characters have been read through the NFA to make up for the cost.
+   * Several threads may ask for it at once.
+   *
+   * @return the DFA, or nullptr if the DFA would have exceeded the state limit
+   */
+  [[nodiscard]] const Dfa* dfa() const;
+
+  /**
+   * Measurements taken while constructing the regular expression, to spot
+   * expressions that are expensive to compile.
+   */
+  struct Profile {
+    /**
+     * The time spent parsing the expression into the automaton.
+     */
+    double parse_seconds = 0;
+
+    /**
+     * The time spent deriving the DFA or Aho-Corasick automaton.
+     */
+    double build_seconds = 0;
+
+    /**
+     * The number of states that only have empty transitions.
+     */
+    std::size_t epsilon_states = 0;
+
+    /**
+     * The number of bytes copied while parsing, i.e. the states moved when the
+     * automaton had to grow.
+     */
+    std::size_t copied_bytes = 0;
+
+    /**
+     * The number of bytes the parser allocated for its bookkeeping, all taken
+     * from the arena.
+     */
+    std::size_t arena_bytes = 0;
+
+    /**
+     * The number of bytes reserved for the states of the automaton.
+     */
+    std::size_t automaton_bytes = 0;
+  };
+
+  /**
+   * Get the measurements taken while constructing the regular expression,
+   * including the time spent deriving the DFA if that happened already.
+   *
+   * @return the measurements
+   */
+  [[nodiscard]] Profile profile() const;
+
 private:
+  friend class Dfa;
+  friend class GraphExporter;
+  friend class Matcher;
+  friend class RegularExpressionSet;
+
   /**
    * A state in the automaton representing the regular expression.
    *
@@ -77,77 +258,313 @@ private:
    */
   int m_initial_state{};
 
+  /**
+   * The final states of the NFA. For a single regular expression, this is
+   * always the last state due to the parser implementation. An automaton
+   * combining several regular expressions has one final state per expression.
+   */
+  std::vector<int> m_final_states{};
+
+  /**
+   * The DFA derived from the automaton on first use, shared by the copies of
+   * the regular expression.
+   */
+  struct LazyDfa {
+    /**
+     * The maximum number of states of the DFA.
+     */
+    std::size_t state_limit = Dfa::DEFAULT_STATE_LIMIT;
+
+    /**
+     * Makes sure the DFA is derived only once.
+     */
+    std::once_flag once{};
+
+    /**
+     * Whether the DFA has been derived or given up on.
+     */
+    std::atomic<bool> built{false};
+
+    /**
+     * The number of characters mat() read through the NFA so far.
+     */
+    std::atomic<std::size_t> simulated_bytes{0};
+
+    /**
+     * The DFA, if it stayed within the state limit.
+     */
+    std::optional<Dfa> dfa{};
+
+    /**
+     * The time spent deriving the DFA.
+     */
+    double build_seconds = 0;
+  };
+
+  /**
+   * The number of characters mat() reads through the NFA before it derives the
+   * DFA.
+   */
+  static constexpr std::size_t LAZY_DFA_BYTES{1 << 16};
+
+  /**
+   * The DFA derived lazily from the automaton, shared between copies.
+   */
+  std::shared_ptr<LazyDfa> m_dfa{};
+
+  /**
+   * The Aho-Corasick automaton used for matching instead of the NFA and DFA,
+   * if the regular expression is an alternation of plain words.
+   */
+  std::optional<AhoCorasick> m_literals{};
+
+  /**
+   * The measurements taken while constructing the regular expression.
+   */
+  Profile m_profile{};
+
+  /**
+   * Split a regular expression into its words, if it is an alternation of
+   * plain words (e.g. "foo|bar|baz"). Words follow the grammar of ⟨term⟩, so
+   * only their first letter may be uppercase.
+   *
+   * @param expression the regular expression to split
+   * @param words the vector to append the words to
+   * @return true if the expression is an alternation of words, false otherwise
+   */
+  static bool splitWords(std::string_view expression,
+                         std::vector<std::string_view>& words);
+
+  /**
+   * Construct a regular expression from an already built automaton.
+   *
+   * @param automaton the automaton
+   * @param initial_state the initial state of the automaton
+   * @param final_states the final states of the automaton
+   * @param state_limit the maximum number of states of the derived DFA
+   */
+  RegularExpression(std::vector<State> automaton, int initial_state,
+                    std::vector<int> final_states, std::size_t state_limit);
+
+  /**
+   * Read a string through the NFA, leaving the states that are active at its
+   * end in the current state list of the scratch buffers.
+   *
+   * @param string the string to read
+   * @param scratch the scratch buffers to use
+   */
+  void simulate(std::string_view string, Scratch& scratch) const;
+
+  /**
+   * Make the states reachable from the initial state by empty transitions the
+   * current state list of the scratch buffers, sizing the buffers so that
+   * continuing the simulation does not allocate.
+   *
+   * @param scratch the scratch buffers to use
+   */
+  void startSimulation(Scratch& scratch) const;
+
+  /**
+   * Read a string through the NFA, starting from the current state list of the
+   * scratch buffers and leaving the reached states in it.
+   *
+   * @param string the string to read
+   * @param scratch the scratch buffers to use
+   */
+  void continueSimulation(std::string_view string, Scratch& scratch) const;
+
+  /**
+   * Get the DFA for mat() to read a string with: the DFA if it was derived
+   * already, or once the NFA would have read enough characters, after deriving
+   * it.
+   *
+   * @param bytes the number of characters of the string to read
+   * @return the DFA, or nullptr if the NFA should read the string
+   */
+  [[nodiscard]] const Dfa* dfaFor(std::size_t bytes) const;
+
+  /**
+   * Check whether the current state list of the scratch buffers contains a
+   * final state.
+   *
+   * @param scratch the scratch buffers to check
+   * @return true if a final state is active, false otherwise
+   */
+  [[nodiscard]] bool accepted(const Scratch& scratch) const;
+
+#ifdef REGEXP_STATISTICS
+  /**
+   * Add the work counted in the scratch buffers to the totals of the process
+   * and start counting from zero again.
+   *
+   * @param scratch the scratch buffers holding the counters
+   */
+  static void recordStatistics(Scratch& scratch);
+#endif
+
+  /**
+   * The number of bytes of the stack buffer the arena used while parsing
+   * starts out with, enough for most expressions.
+   */
+  static constexpr std::size_t ARENA_SIZE{1 << 13};
+
+  /**
+   * An ⟨expr⟩ being parsed, which waits while a group nested in it is parsed.
+   */
+  struct Level {
+    /**
+     * The position in the automaton of the first state of the group.
+     */
+    std::size_t group_position = 0;
+
+    /**
+     * The position in the automaton of the first state of the alternative
+     * being parsed.
+     */
+    std::size_t alternative_position = 0;
+
+    /**
+     * The number of alternatives recorded before this ⟨expr⟩ started.
+     */
+    std::size_t first_alternative = 0;
+
+    /**
+     * The index of the start of the ⟨term⟩ being parsed.
+     */
+    int term_front_index = 0;
+
+    /**
+     * The position in the automaton of the last state of the ⟨term⟩ being
+     * parsed.
+     */
+    std::size_t term_back_position = 0;
+
+    /**
+     * Whether no ⟨fact⟩ of the ⟨term⟩ being parsed has been read yet.
+     */
+    bool term_empty = true;
+  };
+
   /**
    * ⟨expr⟩ := ⟨term⟩ [ | ⟨expr⟩ ]
+   * ⟨term⟩ := ⟨fact⟩ [ ⟨term⟩ ]
+   * ⟨fact⟩ := ⟨lett⟩ [ * ] | ( ⟨expr⟩ ) [ * ]
+   * ⟨lett⟩ := A | B | · · · | Z | a | b | · · · | z
+   *
+   * The states are appended to the automaton as they are read, so no
+   * subautomaton is ever copied. Groups are parsed with an explicit stack of
+   * levels instead of recursion, so deep nesting cannot exhaust the call stack.
+   * Only the levels and the alternatives waiting to be joined are kept in the
+   * arena, and both take space proportional to the length of the expression.
    *
    * @param expression the (remaining) expression to parse
-   * @param next_index the first free index to place the next state at
+   * @param automaton the automaton to append the states to
    * @param start_index the index representing the start of the (sub)automaton
-   * @return the (sub)automaton representing the expression
+   * @param copied_bytes the number of bytes copied while growing the
+   *                     automaton, which is increased accordingly
+   * @param arena the memory resource to allocate the levels and alternatives
+   *              from
    */
-  static std::vector<State> expr(std::istringstream& expression,
-                                 int& next_index, int& start_index);
+  static void expr(std::string_view& expression, std::vector<State>& automaton,
+                   int& start_index, std::size_t& copied_bytes,
+                   std::pmr::memory_resource* arena);
 
   /**
-   * ⟨term⟩ := ⟨fact⟩ [ ⟨term⟩ ]
+   * Repeat the subautomaton that was read last if a '*' follows it.
    *
    * @param expression the (remaining) expression to parse
-   * @param next_index the first free index to place the next state at
-   * @param start_index the index representing the start of the (sub)automaton
-   * @return the (sub)automaton representing the expression
+   * @param automaton the automaton ending in the subautomaton
+   * @param start_index the index representing the start of the subautomaton
+   * @param copied_bytes the number of bytes copied while growing the
+   *                     automaton, which is increased accordingly
    */
-  static std::vector<State> term(std::istringstream& expression,
-                                 int& next_index, int& start_index);
+  static void star(std::string_view& expression, std::vector<State>& automaton,
+                   int& start_index, std::size_t& copied_bytes);
 
   /**
-   * ⟨fact⟩ := ⟨lett⟩ [ * ] | ( ⟨expr⟩ ) [ * ]
-   * ⟨lett⟩ := A | B | · · · | Z | a | b | · · · | z
+   * Give an empty subautomaton, e.g. of an empty alternative or group, a single
+   * state without edges, so it accepts the empty string and can be joined.
+   *
+   * @param automaton the automaton that should end in the subautomaton
+   * @param position the position in the automaton the subautomaton starts at
+   * @param start_index the index representing the start of the subautomaton
+   * @param copied_bytes the number of bytes copied while growing the
+   *                     automaton, which is increased accordingly
+   */
+  static void epsilon(std::vector<State>& automaton, std::size_t position,
+                      int& start_index, std::size_t& copied_bytes);
+
+  /**
+   * Look at the next character of the expression being parsed.
    *
    * @param expression the (remaining) expression to parse
-   * @param next_index the first free index to place the next state at
-   * @param start_index the index representing the start of the (sub)automaton
-   * @return the (sub)automaton representing the expression
+   * @return the next character as an unsigned char, or EOF at the end
    */
-  static std::vector<State> fact(std::istringstream& expression,
-                                 int& next_index, int& start_index);
+  static int peek(std::string_view expression);
 
   /**
-   * Get a single line of dot notation for an edge.
+   * Take the next character of the expression being parsed.
    *
-   * Note: two calls are required for a state with two edges due to this needing
-   * two lines in dot notation.
+   * @param expression the (remaining) expression to parse, which is advanced
+   *                   past the character
+   * @return the character as an unsigned char, or EOF at the end
+   */
+  static int take(std::string_view& expression);
+
+  /**
+   * Append a state to an automaton, keeping count of the bytes copied.
    *
-   * @param state_number the label to be used for the respective state
-   * @param state the state to stringify to dot notation
-   * @param first_edge true if the first edge should be used, false if second
-   * @return the dot notation of the state
+   * @param automaton the automaton to append to
+   * @param state the state to append
+   * @param copied_bytes the number of bytes copied, which is increased by the
+   *                     size of the states the automaton already held if it
+   *                     had to grow
+   */
+  static void emit(std::vector<State>& automaton, State state,
+                   std::size_t& copied_bytes);
+
+  /**
+   * Get the lines of dot notation preceding the edges.
+   *
+   * @return the opening of the graph, up to the edge into the initial state
+   */
+  [[nodiscard]] std::string dotHeader() const;
+
+  /**
+   * The maximum number of characters dotState() writes for a single state.
    */
-  static std::string dotState(int state_number,
-                              const RegularExpression::State& state,
-                              bool first_edge);
+  static constexpr std::ptrdiff_t DOT_STATE_SIZE{2 * 48};
 
   /**
-   * Retrieve the set of states that do not have empty transitions and that can
-   * be reached by empty transitions from the given set of states.
+   * Write the dot notation of the edges of a state, one line per edge.
    *
-   * Acts as a helper function for the recursive implementation of
-   * traverseEmptyTransitionsRecursive().
+   * @param position the buffer position to write to, with room for at least
+   *                 DOT_STATE_SIZE characters
+   * @param state_number the label to be used for the respective state
+   * @param state the state to write the edges of
+   * @return the buffer position after the written edges
+   */
+  static char* dotState(char* position, int state_number,
+                        const RegularExpression::State& state);
+
+  /**
+   * Start a new, empty list of active states.
    *
-   * @param current_states the set of states to traverse from
-   * @return the set of states that can be reached by empty or no transitions
+   * @param scratch the scratch buffers holding the state marks
    */
-  [[nodiscard]] std::set<int> traverseEmptyTransitions(
-      const std::set<int>& current_states) const;
+  void beginStates(Scratch& scratch) const;
 
   /**
-   * Recursive implementation for traverseEmptyTransitions().
+   * Add the given state and every state that can be reached from it by empty
+   * transitions to the given list of active states, skipping states that are
+   * already part of the list.
    *
-   * @param current_states the set of states to traverse from
-   * @param new_states the set of states that have been visited
-   * @return the set of states that can be reached by empty or no transitions
+   * @param state the state to traverse from
+   * @param scratch the scratch buffers holding the state marks
+   * @param states the list of active states to add to
    */
-  [[nodiscard]] std::set<int> traverseEmptyTransitionsRecursive(
-      const std::set<int>& current_states, std::set<int>& new_states) const;
+  void traverseEmptyTransitions(int state, Scratch& scratch,
+                                std::vector<int>& states) const;
 };
 
 #endif
@@ -0,0 +1,112 @@
+/**
+ * This file contains the definition of the RegularExpressionSet class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_REGULAREXPRESSIONSET_H
+#define REGEXP_REGULAREXPRESSIONSET_H
+
+#include "RegularExpression.h"
+#include "Teddy.h"
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class RegularExpressionSet {
+public:
+  /**
+   * The maximum number of states of the DFA derived from the combined
+   * automaton, which is larger than that of a single regular expression.
+   */
+  static constexpr std::size_t STATE_LIMIT{8192};
+
+  /**
+   * Explicit default constructor.
+   */
+  RegularExpressionSet() = default;
+
+  /**
+   * Construct a single automaton accepting the union of the given regular
+   * expressions, in which every expression keeps its own final state.
+   *
+   * @param expressions the regular expressions, identified by their position
+   */
+  explicit RegularExpressionSet(const std::vector<std::string>& expressions);
+
+  /**
+   * Get the identifiers of the regular expressions that accept the given
+   * string, reading the string only once regardless of the number of
+   * regular expressions.
+   *
+   * @param string the string to check
+   * @return the identifiers of the accepting regular expressions in ascending
+   *         order
+   */
+  [[nodiscard]] std::vector<int> matches(std::string_view string) const;
+
+  /**
+   * Get the identifiers of the regular expressions that accept the given
+   * string, using the given scratch buffers instead of allocating new ones.
+   *
+   * @param string the string to check
+   * @param scratch the scratch buffers to use, owned by the calling thread
+   * @return the identifiers of the accepting regular expressions in ascending
+   *         order
+   */
+  [[nodiscard]] std::vector<int> matches(
+      std::string_view string, RegularExpression::Scratch& scratch) const;
+
+  /**
+   * Get the identifiers of the regular expressions that accept some substring
+   * of the given string, reading the string only once.
+   *
+   * @param string the string to search
+   * @return the identifiers of the regular expressions accepting a substring
+   *         in ascending order
+   */
+  [[nodiscard]] std::vector<int> search(std::string_view string) const;
+
+  /**
+   * Get the number of regular expressions in the set.
+   *
+   * @return the number of regular expressions
+   */
+  [[nodiscard]] std::size_t size() const;
+
+private:
+  /**
+   * The automaton combining all regular expressions under a shared initial
+   * state, whose final state with tag i belongs to regular expression i.
+   */
+  RegularExpression m_combined{};
+
+  /**
+   * The Aho-Corasick automaton used instead of the combined automaton, if every
+   * regular expression is an alternation of plain words.
+   */
+  std::optional<AhoCorasick> m_literals{};
+
+  /**
+   * The SIMD prefilter used for searching instead of the Aho-Corasick
+   * automaton, if there are few enough words for it to be effective.
+   */
+  std::optional<Teddy> m_prefilter{};
+
+  /**
+   * The number of regular expressions in the set.
+   */
+  std::size_t m_size{0};
+
+  /**
+   * For every state of the combined automaton, the identifier of the regular
+   * expression it is the final state of, or -1 if it is not a final state.
+   */
+  std::vector<int> m_expression_of{};
+};
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * This file contains the definition of the Teddy class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_TEDDY_H
+#define REGEXP_TEDDY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class Teddy {
+public:
+  /**
+   * The maximum number of literals for which Teddy is worthwhile; with more
+   * literals nearly every position becomes a candidate.
+   */
+  static constexpr std::size_t MAX_LITERALS{48};
+
+  /**
+   * Construct a Teddy searcher for the given literals.
+   *
+   * Literals are spread over eight buckets. For each of the first (up to)
+   * three positions of a literal, two 16-entry tables map the low and high
+   * nibble of a byte to the buckets whose literals allow that nibble there.
+   * A position is a candidate for a bucket if all table lookups for the bytes
+   * starting at it agree on the bucket, which SIMD shuffles check for 16 or 32
+   * positions at once. Candidates are verified by comparing the literals.
+   *
+   * The widest instruction set supported by the CPU is selected at runtime,
+   * falling back to a scalar implementation of the same algorithm.
+   *
+   * @param literals the non-empty literals, each with the tag to report for it
+   */
+  explicit Teddy(const std::vector<std::pair<std::string_view, int>>& literals);
+
+  /**
+   * Get the tags of the literals that occur somewhere in the given string.
+   * Searching stops as soon as every tag has been found.
+   *
+   * @param string the string to search
+   * @return the distinct tags in ascending order
+   */
+  [[nodiscard]] std::vector<int> search(std::string_view string) const;
+
+  /**
+   * Get the name of the instruction set used by search().
+   *
+   * @return "AVX2", "SSSE3" or "scalar"
+   */
+  [[nodiscard]] const char* instructionSet() const;
+
+private:
+  /**
+   * The instruction sets search() can be implemented with.
+   */
+  enum class InstructionSet { SCALAR, SSSE3, AVX2 };
+
+  /**
+   * The tags found while searching.
+   */
+  struct Found {
+    std::vector<char> tags{};
+    std::size_t missing = 0;
+  };
+
+  /**
+   * The literals with their tags, grouped per bucket.
+   */
+  std::array<std::vector<std::pair<std::string, int>>, 8> m_buckets{};
+
+  /**
+   * The number of leading bytes of every literal used for finding candidates.
+   */
+  std::size_t m_fingerprint_length{0};
+
+  /**
+   * Per fingerprint position, the buckets allowing each low nibble.
+   */
+  std::array<std::array<std::uint8_t, 16>, 3> m_low_masks{};
+
+  /**
+   * Per fingerprint position, the buckets allowing each high nibble.
+   */
+  std::array<std::array<std::uint8_t, 16>, 3> m_high_masks{};
+
+  /**
+   * The largest tag plus one.
+   */
+  int m_tag_count{0};
+
+  /**
+   * The number of distinct tags.
+   */
+  std::size_t m_distinct_tags{0};
+
+  /**
+   * The instruction set used by search().
+   */
+  InstructionSet m_instruction_set{InstructionSet::SCALAR};
+
+  /**
+   * Get the buckets for which the given position is a candidate.
+   *
+   * @param string the string being searched
+   * @param position the position, at least m_fingerprint_length bytes before
+   *                 the end of the string
+   * @return the candidate buckets, one bit per bucket
+   */
+  [[nodiscard]] std::uint8_t candidates(std::string_view string,
+                                        std::size_t position) const;
+
+  /**
+   * Verify the literals of the candidate buckets at the given position.
+   *
+   * @param string the string being searched
+   * @param position the position the literals should start at
+   * @param buckets the candidate buckets, one bit per bucket
+   * @param found the tags found so far, to add the found tags to
+   */
+  void verify(std::string_view string, std::size_t position,
+              std::uint8_t buckets, Found& found) const;
+
+  /**
+   * Search using a scalar implementation, starting at the given position.
+   *
+   * @param string the string to search
+   * @param position the first position to consider
+   * @param found the tags found so far, to add the found tags to
+   */
+  void searchScalar(std::string_view string, std::size_t position,
+                    Found& found) const;
+
+  /**
+   * Search 16 positions at a time using SSSE3 instructions.
+   *
+   * @param string the string to search
+   * @param found the tags found so far, to add the found tags to
+   */
+  void searchSsse3(std::string_view string, Found& found) const;
+
+  /**
+   * Search 32 positions at a time using AVX2 instructions.
+   *
+   * @param string the string to search
+   * @param found the tags found so far, to add the found tags to
+   */
+  void searchAvx2(std::string_view string, Found& found) const;
+};
+
+#endif
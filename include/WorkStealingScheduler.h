@@ -0,0 +1,90 @@
+/**
+ * This file contains the definition of the WorkStealingScheduler class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_WORKSTEALINGSCHEDULER_H
+#define REGEXP_WORKSTEALINGSCHEDULER_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class WorkStealingScheduler {
+public:
+  /**
+   * Statistics on the work a single worker performed during a run.
+   */
+  struct WorkerStatistics {
+    std::size_t tasks = 0;
+    std::size_t stolen_tasks = 0;
+    double busy_seconds = 0;
+    double utilization = 0;
+  };
+
+  /**
+   * Construct a scheduler that runs tasks on the given number of workers.
+   *
+   * @param workers the number of worker threads, at least one is used
+   */
+  explicit WorkStealingScheduler(unsigned workers);
+
+  /**
+   * Execute the tasks numbered 0 up to (but excluding) the given number of
+   * tasks and wait until all of them have finished.
+   *
+   * Every worker starts with a contiguous range of the tasks, which it
+   * executes front to back. A worker that runs out of tasks steals from the
+   * back of another worker's range, so skewed task sizes do not leave workers
+   * idle while others are still busy.
+   *
+   * @param tasks the number of tasks to execute
+   * @param execute the function executing a task, given the task number and
+   *                the number of the worker executing it
+   * @return the statistics of every worker during this run
+   * @throws std::system_error if a worker thread cannot be started, once the
+   *         workers that did start have finished their current task
+   */
+  std::vector<WorkerStatistics> run(
+      std::size_t tasks,
+      const std::function<void(std::size_t, unsigned)>& execute);
+
+private:
+  /**
+   * The tasks a single worker still has to execute.
+   */
+  struct Queue {
+    std::mutex mutex{};
+    std::deque<std::size_t> tasks{};
+  };
+
+  /**
+   * The number of worker threads.
+   */
+  unsigned m_workers;
+
+  /**
+   * Take the next task from the front of a worker's own queue.
+   *
+   * @param queue the queue of the worker
+   * @param task the task that was taken, if any
+   * @return true if a task was taken, false if the queue was empty
+   */
+  static bool pop(Queue& queue, std::size_t& task);
+
+  /**
+   * Take a task from the back of another worker's queue.
+   *
+   * @param queue the queue to steal from
+   * @param task the task that was taken, if any
+   * @return true if a task was taken, false if the queue was empty
+   */
+  static bool steal(Queue& queue, std::size_t& task);
+};
+
+#endif
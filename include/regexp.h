@@ -0,0 +1,97 @@
+/**
+ * This file contains the C interface to the RegularExpression class, so the
+ * engine can be linked into programs that are not written in C++.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#ifndef REGEXP_REGEXP_H
+#define REGEXP_REGEXP_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A compiled regular expression. It is not modified by matching, so it can be
+ * used by several threads at once.
+ */
+typedef struct rx_regexp rx_regexp;
+
+/**
+ * The buffers used while matching, which can be reused by successive matches
+ * against any compiled regular expression. It must not be used by several
+ * threads at once.
+ */
+typedef struct rx_scratch rx_scratch;
+
+/**
+ * Compile a regular expression.
+ *
+ * @param pattern the regular expression, which does not have to be
+ *                NUL-terminated
+ * @param length the length of the regular expression in bytes
+ * @return the compiled regular expression, to be released with rx_free(), or
+ *         NULL on any failure
+ */
+rx_regexp* rx_compile(const char* pattern, size_t length);
+
+/**
+ * Check if the given string is accepted by a compiled regular expression. As
+ * with the mat command, the string "$" stands for the empty string.
+ *
+ * The buffers needed for matching are allocated anew by every call; use
+ * rx_match_with() to reuse them when matching many strings.
+ *
+ * @param regexp the compiled regular expression
+ * @param string the string to check, which does not have to be NUL-terminated
+ * @param length the length of the string in bytes
+ * @return 1 if the string matches, 0 if it does not and -1 on any failure
+ */
+int rx_match(const rx_regexp* regexp, const char* string, size_t length);
+
+/**
+ * Create the buffers used while matching, to be passed to rx_match_with().
+ *
+ * @return the buffers, to be released with rx_scratch_free(), or NULL on any
+ *         failure
+ */
+rx_scratch* rx_scratch_new(void);
+
+/**
+ * Check if the given string is accepted by a compiled regular expression like
+ * rx_match() does, reusing the given buffers so that matching does not
+ * allocate once they have grown large enough.
+ *
+ * @param regexp the compiled regular expression
+ * @param scratch the buffers to match with
+ * @param string the string to check, which does not have to be NUL-terminated
+ * @param length the length of the string in bytes
+ * @return 1 if the string matches, 0 if it does not and -1 on any failure
+ */
+int rx_match_with(const rx_regexp* regexp, rx_scratch* scratch,
+                  const char* string, size_t length);
+
+/**
+ * Release the buffers used while matching. Passing NULL does nothing.
+ *
+ * @param scratch the buffers
+ */
+void rx_scratch_free(rx_scratch* scratch);
+
+/**
+ * Release a compiled regular expression. Passing NULL does nothing.
+ *
+ * @param regexp the compiled regular expression
+ */
+void rx_free(rx_regexp* regexp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
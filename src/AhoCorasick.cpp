@@ -0,0 +1,148 @@
+/**
+ * This file contains the implementation of the AhoCorasick class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "AhoCorasick.h"
+#include <algorithm>
+#include <queue>
+
+AhoCorasick::AhoCorasick(
+    const std::vector<std::pair<std::string_view, int>>& literals) {
+  for (const auto& [literal, tag]: literals) {
+    for (auto character: literal) {
+      auto& character_class{m_class_of[static_cast<unsigned char>(character)]};
+      if (character_class == 0) {
+        character_class = m_classes++;
+      }
+    }
+    m_tag_count = std::max(m_tag_count, tag + 1);
+  }
+
+  // Build the trie, with -1 marking transitions that are yet to be filled in
+  m_goto.assign(m_classes, -1);
+  m_depth.push_back(0);
+  m_tags.emplace_back();
+  for (const auto& [literal, tag]: literals) {
+    int state{0};
+    for (auto character: literal) {
+      int& next{m_goto[state * m_classes
+                       + m_class_of[static_cast<unsigned char>(character)]]};
+      if (next == -1) {
+        next = static_cast<int>(m_depth.size());
+        m_goto.insert(m_goto.end(), m_classes, -1);
+        m_depth.push_back(m_depth[state] + 1);
+        m_tags.emplace_back();
+      }
+      state = m_goto[state * m_classes
+                     + m_class_of[static_cast<unsigned char>(character)]];
+    }
+    m_tags[state].push_back(tag);
+  }
+  std::vector<char> seen(m_tag_count, 0);
+  for (auto& tags: m_tags) {
+    std::sort(tags.begin(), tags.end());
+    tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+    for (auto tag: tags) {
+      m_distinct_tags += seen[tag] == 0 ? 1 : 0;
+      seen[tag] = 1;
+    }
+  }
+
+  // Fold the failure links into the table in breadth-first order, so the
+  // failure state of a state is complete before the state itself is handled
+  std::vector<int> failure(m_depth.size(), 0);
+  m_output_link.assign(m_depth.size(), -1);
+  std::queue<int> pending{};
+  for (int character_class{0}; character_class < m_classes;
+       ++character_class) {
+    int& next{m_goto[character_class]};
+    if (next == -1) {
+      next = 0;
+    } else {
+      pending.push(next);
+    }
+  }
+  while (!pending.empty()) {
+    int state{pending.front()};
+    pending.pop();
+    m_output_link[state] = m_tags[failure[state]].empty()
+                               ? m_output_link[failure[state]]
+                               : failure[state];
+    for (int character_class{0}; character_class < m_classes;
+         ++character_class) {
+      int& next{m_goto[state * m_classes + character_class]};
+      int fallback{m_goto[failure[state] * m_classes + character_class]};
+      if (next == -1) {
+        next = fallback;
+      } else {
+        failure[next] = fallback;
+        pending.push(next);
+      }
+    }
+  }
+}
+
+bool AhoCorasick::accepts(std::string_view string) const {
+  int state{walk(ROOT, string)};
+  return state != -1 && accepting(state);
+}
+
+std::vector<int> AhoCorasick::matchWhole(std::string_view string) const {
+  int state{walk(ROOT, string)};
+  return state == -1 ? std::vector<int>{} : m_tags[state];
+}
+
+std::vector<int> AhoCorasick::search(std::string_view string) const {
+  std::vector<char> found(m_tag_count, 0);
+  std::size_t missing{m_distinct_tags};
+  std::vector<char> reported(m_depth.size(), 0);
+  auto report{[&](int state) {
+    // A reported state has had its whole output chain reported as well
+    for (; state != -1 && reported[state] == 0; state = m_output_link[state]) {
+      reported[state] = 1;
+      for (auto tag: m_tags[state]) {
+        if (found[tag] == 0) {
+          found[tag] = 1;
+          --missing;
+        }
+      }
+    }
+  }};
+
+  int state{ROOT};
+  report(state);
+  for (auto character: string) {
+    if (missing == 0) { // Every tag has been found, nothing can change
+      break;
+    }
+    state = step(state, character);
+    report(state);
+  }
+
+  std::vector<int> result{};
+  for (int tag{0}; tag < m_tag_count; ++tag) {
+    if (found[tag] == 1) {
+      result.push_back(tag);
+    }
+  }
+  return result;
+}
+
+int AhoCorasick::walk(int state, std::string_view string) const {
+  int depth{m_depth[state]};
+  for (auto character: string) {
+    state = step(state, character);
+    if (m_depth[state] != ++depth) { // Followed a failure link: off the trie
+      return -1;
+    }
+  }
+  return state;
+}
+
+bool AhoCorasick::accepting(int state) const {
+  return !m_tags[state].empty();
+}
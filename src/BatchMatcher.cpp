@@ -0,0 +1,152 @@
+/**
+ * This file contains the implementation of the BatchMatcher class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "BatchMatcher.h"
+#include <algorithm>
+
+BatchMatcher::BatchMatcher(const RegularExpression& expression)
+    : m_expression{expression} {}
+
+std::size_t BatchMatcher::run(std::string_view input, BufferedWriter& output,
+                              unsigned threads) {
+  std::vector<std::string_view> chunks{split(input, CHUNK_SIZE)};
+  if (threads <= 1) {
+    RegularExpression::Scratch scratch{};
+    std::vector<char> results{};
+    std::size_t lines{0};
+    for (auto chunk: chunks) {
+      results.clear();
+      matchChunk(chunk, scratch, results);
+      for (auto result: results) {
+        output.write(result == 1 ? "match\n" : "no match\n");
+      }
+      lines += results.size();
+    }
+    return lines;
+  }
+
+  // Only derive the DFA if there is a line worth splitting
+  const Dfa* dfa{std::any_of(chunks.begin(), chunks.end(),
+                             [](std::string_view chunk) {
+                               return chunk.size() > CHUNK_SIZE;
+                             })
+                     ? m_expression.dfa()
+                     : nullptr};
+  std::vector<Task> tasks{plan(chunks, dfa, threads)};
+  std::vector<std::vector<char>> results(chunks.size());
+  std::vector<int> states(tasks.size());
+  std::vector<std::vector<int>> transfers(tasks.size());
+  std::vector<RegularExpression::Scratch> scratches(threads);
+  m_statistics = WorkStealingScheduler{threads}.run(
+      tasks.size(), [&](std::size_t task, unsigned worker) {
+        const Task& current{tasks[task]};
+        if (current.kind == Task::Kind::LINES) {
+          matchChunk(current.input, scratches[worker], results[current.chunk]);
+        } else if (current.kind == Task::Kind::FIRST_PART) {
+          states[task] = dfa->run(dfa->initialState(), current.input);
+        } else {
+          transfers[task] = dfa->transfer(current.input);
+        }
+        REGEXP_COUNT(if (current.kind != Task::Kind::LINES) {
+          MatchStatistics statistics{};
+          statistics.dfa_matches = current.kind == Task::Kind::FIRST_PART;
+          statistics.characters = current.input.size();
+          MatchStatistics::record(statistics);
+        });
+      });
+
+  int state{};
+  for (std::size_t task{0}; task < tasks.size(); ++task) {
+    if (tasks[task].kind == Task::Kind::LINES) {
+      continue;
+    }
+    state = tasks[task].kind == Task::Kind::FIRST_PART ? states[task]
+                                                       : transfers[task][state];
+    results[tasks[task].chunk] = {dfa->accepting(state) ? '\1' : '\0'};
+  }
+
+  std::size_t lines{0};
+  for (const auto& chunk_results: results) {
+    for (auto result: chunk_results) {
+      output.write(result == 1 ? "match\n" : "no match\n");
+    }
+    lines += chunk_results.size();
+  }
+  return lines;
+}
+
+const std::vector<WorkStealingScheduler::WorkerStatistics>&
+BatchMatcher::statistics() const {
+  return m_statistics;
+}
+
+std::vector<std::string_view> BatchMatcher::split(std::string_view input,
+                                                  std::size_t chunk_size) {
+  std::vector<std::string_view> chunks{};
+  while (!input.empty()) {
+    std::size_t end{input.size()};
+    if (chunk_size < input.size()) {
+      std::size_t newline_index{input.rfind('\n', chunk_size - 1)};
+      if (newline_index == std::string_view::npos) { // Line exceeds the chunk
+        newline_index = input.find('\n', chunk_size);
+      }
+      if (newline_index != std::string_view::npos) {
+        end = newline_index + 1;
+      }
+    }
+    chunks.push_back(input.substr(0, end));
+    input.remove_prefix(end);
+  }
+  return chunks;
+}
+
+std::vector<BatchMatcher::Task>
+BatchMatcher::plan(const std::vector<std::string_view>& chunks, const Dfa* dfa,
+                   unsigned threads) {
+  std::vector<Task> tasks{};
+  for (std::size_t chunk{0}; chunk < chunks.size(); ++chunk) {
+    std::string_view line{chunks[chunk]};
+    if (dfa == nullptr || line.size() <= CHUNK_SIZE) {
+      tasks.push_back({Task::Kind::LINES, chunk, line});
+      continue;
+    }
+
+    line = nextLine(line); // An oversized chunk holds a single line
+    std::size_t part_size{
+        std::max<std::size_t>(line.size() / (threads * 4), PART_SIZE)};
+    tasks.push_back({Task::Kind::FIRST_PART, chunk, line.substr(0, part_size)});
+    for (std::size_t start{part_size}; start < line.size();
+         start += part_size) {
+      tasks.push_back(
+          {Task::Kind::NEXT_PART, chunk, line.substr(start, part_size)});
+    }
+  }
+  return tasks;
+}
+
+void BatchMatcher::matchChunk(std::string_view chunk,
+                              RegularExpression::Scratch& scratch,
+                              std::vector<char>& results) const {
+  std::vector<std::string_view> lines{};
+  while (!chunk.empty()) {
+    lines.push_back(nextLine(chunk));
+  }
+  m_expression.matBatch(lines, scratch, results);
+}
+
+std::string_view BatchMatcher::nextLine(std::string_view& input) {
+  std::size_t newline_index{input.find('\n')};
+  std::string_view line{input.substr(0, newline_index)};
+  input.remove_prefix(newline_index == std::string_view::npos
+                          ? input.size()
+                          : newline_index + 1);
+  if (!line.empty() && line.back() == '\r') {
+    line.remove_suffix(1);
+  }
+  return line;
+}
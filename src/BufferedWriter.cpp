@@ -0,0 +1,55 @@
+/**
+ * This file contains the implementation of the BufferedWriter class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "BufferedWriter.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <unistd.h>
+
+BufferedWriter::BufferedWriter(int descriptor, std::size_t capacity)
+    : m_descriptor{descriptor}, m_buffer(capacity == 0 ? 1 : capacity) {}
+
+BufferedWriter::~BufferedWriter() {
+  try {
+    flush();
+  } catch (const std::system_error&) {
+    // Destructors must not throw; the output is lost either way
+  }
+}
+
+void BufferedWriter::write(std::string_view string) {
+  while (!string.empty()) {
+    if (m_used == m_buffer.size()) {
+      flush();
+    }
+    std::size_t length{std::min(string.size(), m_buffer.size() - m_used)};
+    std::memcpy(m_buffer.data() + m_used, string.data(), length);
+    m_used += length;
+    string.remove_prefix(length);
+  }
+}
+
+void BufferedWriter::flush() {
+  std::size_t written{0};
+  while (written < m_used) {
+    ssize_t result{::write(m_descriptor, m_buffer.data() + written,
+                           m_used - written)};
+    if (result == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int error{errno};
+      m_used = 0;
+      throw std::system_error{error, std::generic_category(), "write"};
+    }
+    written += static_cast<std::size_t>(result);
+  }
+  m_used = 0;
+}
@@ -0,0 +1,268 @@
+/**
+ * This file contains the implementation of the CommandPipeline class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "CommandPipeline.h"
+#include "BufferedWriter.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <exception>
+#include <map>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+/**
+ * The number of bytes of the script read at once.
+ */
+constexpr std::size_t READ_SIZE{1 << 20};
+
+/**
+ * Get the first whitespace-delimited word of a line, as reading a token from
+ * a stream would.
+ *
+ * @param line the line
+ * @return the first word, empty if the line is blank
+ */
+std::string_view firstWord(std::string_view line) {
+  auto begin{std::find_if(line.begin(), line.end(), [](char character) {
+    return !std::isspace(static_cast<unsigned char>(character));
+  })};
+  auto end{std::find_if(begin, line.end(), [](char character) {
+    return std::isspace(static_cast<unsigned char>(character));
+  })};
+  return line.substr(static_cast<std::size_t>(begin - line.begin()),
+                     static_cast<std::size_t>(end - begin));
+}
+} // namespace
+
+CommandPipeline::CommandPipeline(unsigned threads)
+    : m_threads{std::max(threads, 1U)}, m_parsed{2 * m_threads + 2},
+      m_matched{2 * m_threads + 2} {}
+
+void CommandPipeline::run(int input, int output) {
+  // Batches finish out of order, so later ones wait until their turn
+  BufferedWriter writer{output};
+  std::map<std::size_t, std::unique_ptr<Batch>> waiting{};
+  std::size_t next_sequence{0};
+  std::exception_ptr write_error{};
+  std::exception_ptr parse_error{};
+  std::vector<std::exception_ptr> match_errors(m_threads);
+  std::vector<std::thread> matchers{};
+  std::thread parser{};
+  try {
+    for (unsigned thread{0}; thread < m_threads; ++thread) {
+      matchers.emplace_back([this, &error = match_errors[thread]] {
+        try {
+          match();
+        } catch (...) {
+          error = std::current_exception();
+          while (m_parsed.pop()) { // Keep the parser from blocking
+          }
+          m_matched.push(nullptr);
+        }
+      });
+    }
+    parser = std::thread{[&] {
+      try {
+        parse(input);
+      } catch (...) {
+        parse_error = std::current_exception();
+        for (unsigned thread{0}; thread < m_threads; ++thread) {
+          m_parsed.push(nullptr);
+        }
+      }
+    }};
+  } catch (...) {
+    // Stop the matchers that did start and leave the queues empty
+    for (std::size_t thread{0}; thread < matchers.size(); ++thread) {
+      m_parsed.push(nullptr);
+    }
+    for (auto& matcher: matchers) {
+      matcher.join();
+      m_matched.pop();
+    }
+    throw;
+  }
+
+  for (unsigned stopped{0}; stopped < m_threads;) {
+    std::unique_ptr<Batch> batch{m_matched.pop()};
+    if (!batch) {
+      ++stopped;
+      continue;
+    } else if (write_error) {
+      continue; // Only drain the other stages
+    }
+
+    try {
+      waiting.emplace(batch->sequence, std::move(batch));
+      while (!waiting.empty() && waiting.begin()->first == next_sequence) {
+        writer.write(waiting.begin()->second->output);
+        waiting.erase(waiting.begin());
+        ++next_sequence;
+      }
+    } catch (...) {
+      write_error = std::current_exception();
+      waiting.clear();
+    }
+  }
+
+  parser.join();
+  for (auto& matcher: matchers) {
+    matcher.join();
+  }
+  if (parse_error) {
+    std::rethrow_exception(parse_error);
+  }
+  for (const auto& match_error: match_errors) {
+    if (match_error) {
+      std::rethrow_exception(match_error);
+    }
+  }
+  if (write_error) {
+    std::rethrow_exception(write_error);
+  }
+  writer.flush();
+}
+
+void CommandPipeline::parse(int input) {
+  auto expression{std::make_shared<const RegularExpression>()};
+  auto batch{std::make_unique<Batch>()};
+  std::size_t sequence{0};
+  int expression_index{-1}; // Of the current expression in the batch
+  std::string_view pending_prompt{}; // Of an exp or mat awaiting its argument
+  bool pending_match{false};
+  std::string carry{};
+  bool ended{false};
+
+  auto flush{[&] {
+    if (!batch->commands.empty()) {
+      batch->sequence = sequence++;
+      auto text{batch->text};
+      m_parsed.push(std::move(batch));
+      batch = std::make_unique<Batch>();
+      batch->text = std::move(text);
+      expression_index = -1;
+    }
+  }};
+
+  while (!ended) {
+    auto text{std::make_shared<std::string>(std::move(carry))};
+    std::size_t kept{text->size()};
+    text->resize(kept + READ_SIZE);
+    ssize_t received{::read(input, text->data() + kept, READ_SIZE)};
+    if (received == -1 && errno == EINTR) {
+      carry.assign(*text, 0, kept);
+      continue;
+    } else if (received == -1) {
+      throw std::system_error{errno, std::generic_category(), "read"};
+    }
+    text->resize(kept + static_cast<std::size_t>(received));
+    ended = received == 0;
+
+    // Only complete lines are executed, unless the script ended
+    std::size_t complete{ended ? text->size() : text->rfind('\n') + 1};
+    carry.assign(*text, complete, std::string::npos);
+    text->resize(complete);
+    flush(); // A batch only refers to a single block
+    batch->text = text;
+
+    std::string_view remaining{*text};
+    while (!remaining.empty()) {
+      std::size_t line_end{std::min(remaining.find('\n'), remaining.size())};
+      std::string_view line{remaining.substr(0, line_end)};
+      remaining.remove_prefix(std::min(line_end + 1, remaining.size()));
+
+      bool is_match{pending_match};
+      bool is_expression{!pending_prompt.empty() && !pending_match};
+      std::string_view prefix{pending_prompt};
+      std::string_view argument{line};
+      if (pending_prompt.empty()) {
+        line = line.substr(0, line.find('\r'));
+        std::string_view word{firstWord(line)};
+        std::size_t word_end{
+            static_cast<std::size_t>(word.data() - line.data()) + word.size()};
+        bool has_argument{!firstWord(line.substr(word_end)).empty()};
+        if (word == "exp" || word == "mat") {
+          is_match = word == "mat";
+          is_expression = !is_match;
+          if (has_argument) {
+            argument = line.substr(word_end + 1); // Skip the separating space
+          } else {
+            pending_match = is_match;
+            pending_prompt = is_match ? "Please enter a string to check:"
+                                      : "Please enter a regular expression:";
+            continue; // The argument is on the next line
+          }
+        } else if (word == "end") {
+          ended = true;
+          break;
+        } else if (word.empty()) {
+          batch->commands.push_back({"Unknown command: (none)\n"});
+          continue;
+        } else {
+          batch->commands.push_back({"Unknown command: ", -1, word});
+          continue;
+        }
+      }
+      pending_prompt = {};
+      pending_match = false;
+
+      if (is_expression) {
+        expression = std::make_shared<const RegularExpression>(argument);
+        expression_index = -1;
+        if (!prefix.empty()) {
+          batch->commands.push_back({prefix});
+        }
+      } else if (is_match) {
+        if (expression_index == -1) {
+          expression_index = static_cast<int>(batch->expressions.size());
+          batch->expressions.push_back(expression);
+        }
+        batch->commands.push_back({prefix, expression_index, argument});
+      }
+
+      if (batch->commands.size() >= BATCH_COMMANDS) {
+        flush();
+      }
+    }
+  }
+
+  if (pending_match) { // The script ended early, leaving an empty argument
+    batch->expressions.push_back(expression);
+    batch->commands.push_back(
+        {pending_prompt, static_cast<int>(batch->expressions.size() - 1)});
+  } else if (!pending_prompt.empty()) {
+    batch->commands.push_back({pending_prompt});
+  }
+  flush();
+  for (unsigned thread{0}; thread < m_threads; ++thread) {
+    m_parsed.push(nullptr);
+  }
+}
+
+void CommandPipeline::match() {
+  RegularExpression::Scratch scratch{};
+  while (std::unique_ptr<Batch> batch{m_parsed.pop()}) {
+    for (const auto& command: batch->commands) {
+      batch->output.append(command.prefix);
+      if (command.expression != -1) {
+        bool match{batch->expressions[static_cast<std::size_t>(
+                                          command.expression)]
+                       ->mat(command.string, scratch)};
+        batch->output.append(match ? "match\n" : "no match\n");
+      } else if (!command.string.empty()) {
+        batch->output.append(command.string).push_back('\n');
+      }
+    }
+    m_matched.push(std::move(batch));
+  }
+  m_matched.push(nullptr);
+}
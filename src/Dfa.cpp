@@ -0,0 +1,295 @@
+/**
+ * This file contains the implementation of the Dfa class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "Dfa.h"
+#include "RegularExpression.h"
+#include <algorithm>
+#include <map>
+#include <numeric>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define REGEXP_DFA_X86
+#include <immintrin.h>
+#endif
+
+std::optional<Dfa> Dfa::build(const RegularExpression& expression,
+                              std::size_t state_limit) {
+  const auto& automaton{expression.m_automaton};
+  if (automaton.empty()) {
+    return std::nullopt;
+  }
+  std::vector<int> tag_of(automaton.size(), -1);
+  for (std::size_t tag{0}; tag < expression.m_final_states.size(); ++tag) {
+    tag_of[expression.m_final_states[tag]] = static_cast<int>(tag);
+  }
+
+  Dfa dfa{};
+  std::vector<unsigned char> characters{};
+  for (const auto& state: automaton) {
+    auto character{static_cast<unsigned char>(state.character)};
+    if (character != '\0' && dfa.m_class_of[character] == 0) {
+      dfa.m_class_of[character] = dfa.m_classes++;
+      characters.push_back(character);
+    }
+  }
+
+  // A set of NFA states is identified by the states that can read a character
+  // and the final states; the other states do not influence the behaviour
+  RegularExpression::Scratch scratch{};
+  scratch.m_marks.assign(automaton.size(), 0);
+  auto identify{[&](std::vector<int>& states) {
+    states.erase(std::remove_if(states.begin(), states.end(),
+                                [&](int state) {
+                                  return automaton[state].character == '\0'
+                                         && tag_of[state] == -1;
+                                }),
+                 states.end());
+    std::sort(states.begin(), states.end());
+  }};
+
+  std::map<std::vector<int>, int> state_of{{{}, DEAD_STATE}};
+  std::map<std::vector<int>, int> tag_set_of{{{}, 0}};
+  std::vector<std::vector<int>> sets{{}};
+  std::vector<int> initial{};
+  expression.beginStates(scratch);
+  expression.traverseEmptyTransitions(expression.m_initial_state, scratch,
+                                      initial);
+  identify(initial);
+  if (!initial.empty()) {
+    dfa.m_initial_state = static_cast<int>(sets.size());
+    state_of.emplace(initial, dfa.m_initial_state);
+    sets.push_back(std::move(initial));
+  }
+
+  for (std::size_t current{0}; current < sets.size(); ++current) {
+    std::vector<int> tags{};
+    for (auto state: sets[current]) {
+      if (tag_of[state] != -1) {
+        tags.push_back(tag_of[state]);
+      }
+    }
+    std::sort(tags.begin(), tags.end());
+    auto [tag_set, new_tag_set]{tag_set_of.try_emplace(
+        tags, static_cast<int>(dfa.m_tag_sets.size()))};
+    if (new_tag_set) {
+      dfa.m_tag_sets.push_back(std::move(tags));
+    }
+    dfa.m_tag_set_of.push_back(tag_set->second);
+
+    dfa.m_transitions.push_back(DEAD_STATE); // Class 0 never matches
+    for (auto character: characters) {
+      std::vector<int> next{};
+      expression.beginStates(scratch);
+      for (auto state: sets[current]) {
+        if (static_cast<unsigned char>(automaton[state].character)
+            == character) {
+          expression.traverseEmptyTransitions(automaton[state].first_outgoing,
+                                              scratch, next);
+        }
+      }
+      identify(next);
+
+      auto [entry, inserted]{
+          state_of.try_emplace(next, static_cast<int>(sets.size()))};
+      if (inserted) {
+        if (sets.size() == state_limit) {
+          return std::nullopt;
+        }
+        sets.push_back(std::move(next));
+      }
+      dfa.m_transitions.push_back(entry->second);
+    }
+  }
+
+#ifdef REGEXP_DFA_X86
+  __builtin_cpu_init();
+  dfa.m_avx2 = __builtin_cpu_supports("avx2");
+#endif
+  return dfa;
+}
+
+int Dfa::run(int state, std::string_view string) const {
+  for (auto character: string) {
+    state = step(state, static_cast<unsigned char>(character));
+    if (state == DEAD_STATE) { // The rest of the string cannot change this
+      break;
+    }
+  }
+  return state;
+}
+
+std::vector<int> Dfa::transfer(std::string_view string) const {
+  constexpr std::size_t BLOCK_SIZE{4096};
+
+  // Every run is a lane; a lane is shared by all states whose runs merged
+  std::vector<int> lanes(size());
+  std::iota(lanes.begin(), lanes.end(), 0);
+  std::vector<int> lane_of(lanes);
+  std::vector<int> merged_lane_of_state(size(), -1);
+
+  while (!string.empty()) {
+    std::string_view block{string.substr(0, BLOCK_SIZE)};
+    string.remove_prefix(block.size());
+    for (auto& lane: lanes) {
+      lane = run(lane, block);
+    }
+
+    if (lanes.size() > 1) {
+      std::vector<int> merged_lanes{};
+      std::vector<int> remap(lanes.size());
+      for (std::size_t lane{0}; lane < lanes.size(); ++lane) {
+        int& merged_lane{merged_lane_of_state[lanes[lane]]};
+        if (merged_lane == -1) {
+          merged_lane = static_cast<int>(merged_lanes.size());
+          merged_lanes.push_back(lanes[lane]);
+        }
+        remap[lane] = merged_lane;
+      }
+      for (auto state: merged_lanes) {
+        merged_lane_of_state[state] = -1;
+      }
+      for (auto& lane: lane_of) {
+        lane = remap[lane];
+      }
+      lanes.swap(merged_lanes);
+    }
+    if (lanes.size() == 1 && lanes.front() == DEAD_STATE) {
+      break;
+    }
+  }
+
+  std::vector<int> result(size());
+  for (std::size_t state{0}; state < size(); ++state) {
+    result[state] = lanes[lane_of[state]];
+  }
+  return result;
+}
+
+template <typename Kernel>
+void Dfa::runLanes(const std::string_view* strings, std::size_t count,
+                   int* states, Kernel kernel) const {
+  constexpr std::size_t MAX_STEPS{16}; // Steps between checks for dead lanes
+
+  // An idle lane, without a string, follows the string of an active lane so
+  // the kernel needs no branches; its state is never stored
+  const char* positions[LANES]{};
+  std::size_t remaining[LANES]{};
+  std::size_t string_of_lane[LANES]{};
+  alignas(32) int lane_states[LANES]{};
+  std::size_t next_string{0};
+  auto refill{[&](std::size_t lane) {
+    while (next_string < count && strings[next_string].empty()) {
+      states[next_string++] = m_initial_state;
+    }
+    if (next_string < count) {
+      positions[lane] = strings[next_string].data();
+      remaining[lane] = strings[next_string].size();
+      string_of_lane[lane] = next_string++;
+    } else {
+      positions[lane] = nullptr;
+      remaining[lane] = 0;
+    }
+    lane_states[lane] = m_initial_state;
+  }};
+  for (std::size_t lane{0}; lane < LANES; ++lane) {
+    refill(lane);
+  }
+
+  bool idle[LANES]{};
+  while (true) {
+    std::size_t active{LANES};
+    std::size_t steps{0};
+    for (std::size_t lane{0}; lane < LANES; ++lane) {
+      idle[lane] = positions[lane] == nullptr;
+      if (!idle[lane]) {
+        steps = steps == 0 ? remaining[lane] : std::min(steps, remaining[lane]);
+        active = lane;
+      }
+    }
+    steps = std::min(steps, MAX_STEPS);
+    if (active == LANES) {
+      return;
+    }
+    for (std::size_t lane{0}; lane < LANES; ++lane) {
+      if (idle[lane]) {
+        positions[lane] = positions[active];
+      }
+    }
+
+    // Every lane has at least the given number of steps left
+    kernel(positions, steps, lane_states);
+
+    for (std::size_t lane{0}; lane < LANES; ++lane) {
+      if (idle[lane]) {
+        positions[lane] = nullptr;
+        continue;
+      }
+      positions[lane] += steps;
+      remaining[lane] -= steps;
+      if (remaining[lane] == 0 || lane_states[lane] == DEAD_STATE) {
+        states[string_of_lane[lane]] = lane_states[lane];
+        refill(lane);
+      }
+    }
+  }
+}
+
+void Dfa::runBatch(const std::string_view* strings, std::size_t count,
+                   int* states) const {
+  if (m_avx2) {
+    runLanes(strings, count, states,
+             [this](const char* const* positions, std::size_t steps,
+                    int* lane_states) {
+               stepLanesAvx2(positions, steps, lane_states);
+             });
+  } else {
+    runLanes(strings, count, states,
+             [this](const char* const* positions, std::size_t steps,
+                    int* lane_states) {
+               stepLanes(positions, steps, lane_states);
+             });
+  }
+}
+
+void Dfa::stepLanes(const char* const* positions, std::size_t steps,
+                    int* lane_states) const {
+  for (std::size_t step{0}; step < steps; ++step) {
+    for (std::size_t lane{0}; lane < LANES; ++lane) {
+      lane_states[lane] = this->step(
+          lane_states[lane], static_cast<unsigned char>(positions[lane][step]));
+    }
+  }
+}
+
+#ifdef REGEXP_DFA_X86
+__attribute__((target("avx2"))) void Dfa::stepLanesAvx2(
+    const char* const* positions, std::size_t steps, int* lane_states) const {
+  alignas(32) int bytes[LANES]{};
+  const __m256i classes{_mm256_set1_epi32(m_classes)};
+  __m256i current{_mm256_load_si256(reinterpret_cast<__m256i*>(lane_states))};
+  for (std::size_t step{0}; step < steps; ++step) {
+    for (std::size_t lane{0}; lane < LANES; ++lane) {
+      bytes[lane] = static_cast<unsigned char>(positions[lane][step]);
+    }
+    __m256i character_classes{_mm256_i32gather_epi32(
+        m_class_of.data(),
+        _mm256_load_si256(reinterpret_cast<__m256i*>(bytes)), 4)};
+    current = _mm256_i32gather_epi32(
+        m_transitions.data(),
+        _mm256_add_epi32(_mm256_mullo_epi32(current, classes),
+                         character_classes),
+        4);
+  }
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lane_states), current);
+}
+#else
+void Dfa::stepLanesAvx2(const char* const* positions, std::size_t steps,
+                        int* lane_states) const {
+  stepLanes(positions, steps, lane_states);
+}
+#endif
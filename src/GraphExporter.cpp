@@ -0,0 +1,224 @@
+/**
+ * This file contains the implementation of the GraphExporter class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "GraphExporter.h"
+#include "BufferedWriter.h"
+#include "WorkStealingScheduler.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+/**
+ * Append an unsigned integer in little-endian byte order to a buffer.
+ *
+ * @tparam Integer the unsigned integer type, whose size is written
+ * @param position the buffer position to write to
+ * @param value the integer to write
+ * @return the buffer position after the integer
+ */
+template <typename Integer>
+char* putLittleEndian(char* position, Integer value) {
+  for (std::size_t byte{0}; byte < sizeof(Integer); ++byte) {
+    *position++ = static_cast<char>((value >> (8 * byte)) & 0xFF);
+  }
+  return position;
+}
+} // namespace
+
+GraphExporter::GraphExporter(const RegularExpression& expression)
+    : m_expression{expression} {}
+
+void GraphExporter::dot(int descriptor, unsigned threads) const {
+  const auto& automaton{m_expression.m_automaton};
+  BufferedWriter writer{descriptor};
+  writer.write(m_expression.dotHeader());
+
+  // A few chunks per thread keep the threads busy when chunks differ in size
+  std::size_t chunks{(automaton.size() + CHUNK_STATES - 1) / CHUNK_STATES};
+  std::size_t round_chunks{4 * static_cast<std::size_t>(std::max(threads, 1U))};
+  std::vector<std::string> buffers(std::min(chunks, round_chunks));
+  WorkStealingScheduler scheduler{threads};
+  for (std::size_t first{0}; first < chunks; first += round_chunks) {
+    std::size_t count{std::min(round_chunks, chunks - first)};
+    scheduler.run(count, [&](std::size_t task, unsigned) {
+      std::size_t begin{(first + task) * CHUNK_STATES};
+      std::size_t end{std::min(begin + CHUNK_STATES, automaton.size())};
+      std::string& buffer{buffers[task]};
+      buffer.resize((end - begin) * RegularExpression::DOT_STATE_SIZE);
+      char* position{buffer.data()};
+      for (std::size_t state{begin}; state < end; ++state) {
+        position = RegularExpression::dotState(
+            position, static_cast<int>(state + 1), automaton[state]);
+      }
+      buffer.resize(static_cast<std::size_t>(position - buffer.data()));
+    });
+
+    for (std::size_t task{0}; task < count; ++task) {
+      writer.write(buffers[task]);
+    }
+  }
+
+  writer.write("}");
+  writer.flush();
+}
+
+void GraphExporter::region(int descriptor, int state, std::size_t depth) const {
+  const auto& automaton{m_expression.m_automaton};
+
+  // Breadth-first, remembering only the states of the region
+  std::unordered_map<int, std::size_t> distance_of{{state - 1, 0}};
+  std::vector<int> region{state - 1};
+  for (std::size_t next{0}; next < region.size(); ++next) {
+    std::size_t distance{distance_of[region[next]]};
+    const auto& current{automaton[static_cast<std::size_t>(region[next])]};
+    for (int target: {current.first_outgoing, current.second_outgoing}) {
+      if (distance < depth && target != -1
+          && distance_of.emplace(target, distance + 1).second) {
+        region.push_back(target);
+      }
+    }
+  }
+
+  BufferedWriter writer{descriptor};
+  std::array<char, RegularExpression::DOT_STATE_SIZE> buffer{};
+  auto line{[&](std::string_view prefix, int state_number,
+                 std::string_view attributes) {
+    char* end{
+        std::to_chars(buffer.data(), buffer.data() + buffer.size(), state_number)
+            .ptr};
+    writer.write(prefix);
+    writer.write({buffer.data(), static_cast<std::size_t>(end - buffer.data())});
+    writer.write(attributes);
+  }};
+  writer.write("digraph {\n"
+               "\trankdir = LR\n"
+               "\tnode [shape = circle, style = filled, fillcolor = gray93]\n");
+  for (auto final_state: m_expression.m_final_states) {
+    if (distance_of.count(final_state) != 0) {
+      line("\t", final_state + 1, " [shape = doublecircle]\n");
+    }
+  }
+  if (distance_of.count(m_expression.m_initial_state) != 0) {
+    line("\t0 [style = invisible]\n\t0 -> ", m_expression.m_initial_state + 1,
+         "\n");
+  }
+  line("\t", state, " [fillcolor = lightblue]\n");
+
+  // The edges of the states at the full depth lead out of the region
+  for (int current: region) {
+    if (distance_of[current] < depth) {
+      char* end{RegularExpression::dotState(
+          buffer.data(), current + 1,
+          automaton[static_cast<std::size_t>(current)])};
+      writer.write(
+          {buffer.data(), static_cast<std::size_t>(end - buffer.data())});
+    }
+  }
+  writer.write("}");
+  writer.flush();
+}
+
+void GraphExporter::binary(int descriptor) const {
+  const auto& automaton{m_expression.m_automaton};
+  const auto& final_states{m_expression.m_final_states};
+  BufferedWriter writer{descriptor};
+  std::array<char, 32> buffer{};
+
+  char* position{std::copy_n("RXEL", 4, buffer.data())};
+  position = putLittleEndian<std::uint32_t>(position, 1);
+  position = putLittleEndian(position,
+                             static_cast<std::uint32_t>(automaton.size()));
+  position = putLittleEndian(
+      position, static_cast<std::uint32_t>(m_expression.m_initial_state));
+  position = putLittleEndian(position,
+                             static_cast<std::uint32_t>(final_states.size()));
+  writer.write({buffer.data(), static_cast<std::size_t>(position
+                                                        - buffer.data())});
+  for (auto state: final_states) {
+    putLittleEndian(buffer.data(), static_cast<std::uint32_t>(state));
+    writer.write({buffer.data(), sizeof(std::uint32_t)});
+  }
+
+  std::uint64_t edges{0};
+  for (const auto& state: automaton) {
+    edges += (state.first_outgoing != -1 ? 1 : 0)
+             + (state.second_outgoing != -1 ? 1 : 0);
+  }
+  putLittleEndian(buffer.data(), edges);
+  writer.write({buffer.data(), sizeof(edges)});
+
+  auto edge{[&](std::size_t source, int target, char label) {
+    char* end{putLittleEndian(buffer.data(), static_cast<std::uint32_t>(source))};
+    end = putLittleEndian(end, static_cast<std::uint32_t>(target));
+    *end++ = label;
+    writer.write({buffer.data(), static_cast<std::size_t>(end - buffer.data())});
+  }};
+  for (std::size_t source{0}; source < automaton.size(); ++source) {
+    const auto& state{automaton[source]};
+    if (state.first_outgoing != -1) {
+      edge(source, state.first_outgoing, state.character);
+    }
+    if (state.second_outgoing != -1) {
+      edge(source, state.second_outgoing, '\0');
+    }
+  }
+  writer.flush();
+}
+
+void GraphExporter::json(int descriptor) const {
+  const auto& automaton{m_expression.m_automaton};
+  BufferedWriter writer{descriptor};
+  std::array<char, 64> buffer{};
+  auto number{[&](long long value) {
+    auto result{std::to_chars(buffer.data(), buffer.data() + buffer.size(),
+                              value)};
+    writer.write({buffer.data(),
+                  static_cast<std::size_t>(result.ptr - buffer.data())});
+  }};
+
+  writer.write("{\"states\": ");
+  number(static_cast<long long>(automaton.size()));
+  writer.write(", \"initial\": ");
+  number(m_expression.m_initial_state);
+  writer.write(", \"final\": [");
+  for (std::size_t index{0}; index < m_expression.m_final_states.size();
+       ++index) {
+    writer.write(index == 0 ? "" : ", ");
+    number(m_expression.m_final_states[index]);
+  }
+  writer.write("],\n \"adjacency\": [");
+
+  for (std::size_t source{0}; source < automaton.size(); ++source) {
+    const auto& state{automaton[source]};
+    writer.write(source == 0 ? "[" : ",\n  [");
+    if (state.first_outgoing != -1) {
+      writer.write("[");
+      number(state.first_outgoing);
+      if (state.character != '\0') { // Always a letter, needing no escapes
+        char label[]{',', ' ', '"', state.character, '"', ']'};
+        writer.write({label, sizeof(label)});
+      } else {
+        writer.write(", null]");
+      }
+    }
+    if (state.second_outgoing != -1) {
+      writer.write(state.first_outgoing != -1 ? ", [" : "[");
+      number(state.second_outgoing);
+      writer.write(", null]");
+    }
+    writer.write("]");
+  }
+  writer.write("]}\n");
+  writer.flush();
+}
@@ -0,0 +1,53 @@
+/**
+ * This file contains the implementation of the MappedFile class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "MappedFile.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path) {
+  int descriptor{::open(path.c_str(), O_RDONLY)};
+  if (descriptor == -1) {
+    throw std::system_error{errno, std::generic_category(), path};
+  }
+
+  struct stat status {};
+  if (::fstat(descriptor, &status) == -1) {
+    int error{errno};
+    ::close(descriptor);
+    throw std::system_error{error, std::generic_category(), path};
+  }
+
+  m_size = static_cast<std::size_t>(status.st_size);
+  if (m_size != 0) {
+    void* mapping{::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor,
+                         0)};
+    if (mapping == MAP_FAILED) {
+      int error{errno};
+      ::close(descriptor);
+      throw std::system_error{error, std::generic_category(), path};
+    }
+    ::madvise(mapping, m_size, MADV_SEQUENTIAL);
+    m_data = static_cast<const char*>(mapping);
+  }
+  ::close(descriptor); // The mapping stays valid after closing
+}
+
+MappedFile::~MappedFile() {
+  if (m_data != nullptr) {
+    ::munmap(const_cast<char*>(m_data), m_size);
+  }
+}
+
+std::string_view MappedFile::contents() const {
+  return {m_data, m_size};
+}
@@ -0,0 +1,163 @@
+/**
+ * This file contains the implementation of the MatchClient class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "MatchClient.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace {
+/**
+ * Append a 32-bit integer to a request.
+ *
+ * @param output the buffer to append to
+ * @param value the integer to append
+ */
+void appendInteger(std::vector<char>& output, std::uint32_t value) {
+  char bytes[sizeof(value)];
+  std::memcpy(bytes, &value, sizeof(value));
+  output.insert(output.end(), bytes, bytes + sizeof(value));
+}
+
+/**
+ * Transfer an exact number of bytes over a socket, retrying on short
+ * transfers and interrupts.
+ *
+ * @param socket the socket
+ * @param data the bytes to send or the buffer to receive into
+ * @param size the number of bytes
+ * @param sending true to send, false to receive
+ * @throws std::system_error if the transfer fails or the server hung up
+ */
+void transfer(int socket, char* data, std::size_t size, bool sending) {
+  while (size > 0) {
+    ssize_t done{sending ? ::send(socket, data, size, MSG_NOSIGNAL)
+                         : ::recv(socket, data, size, 0)};
+    if (done == -1 && errno == EINTR) {
+      continue;
+    } else if (done == -1) {
+      throw std::system_error{errno, std::generic_category(), "match server"};
+    } else if (done == 0) {
+      throw std::system_error{ECONNRESET, std::generic_category(),
+                              "match server"};
+    }
+    data += done;
+    size -= static_cast<std::size_t>(done);
+  }
+}
+} // namespace
+
+MatchClient::MatchClient(const std::string& path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw std::system_error{ENAMETOOLONG, std::generic_category(), path};
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  m_socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (m_socket == -1) {
+    throw std::system_error{errno, std::generic_category(), "socket"};
+  }
+  if (::connect(m_socket, reinterpret_cast<const sockaddr*>(&address),
+                sizeof(address))
+      == -1) {
+    int error{errno};
+    ::close(m_socket);
+    throw std::system_error{error, std::generic_category(), path};
+  }
+}
+
+MatchClient::~MatchClient() {
+  ::close(m_socket);
+}
+
+std::uint32_t MatchClient::compile(std::string_view expression) {
+  start(MatchServer::Request::COMPILE);
+  m_buffer.insert(m_buffer.end(), expression.begin(), expression.end());
+  std::string_view response{exchange()};
+  std::uint32_t id{};
+  if (response.size() != sizeof(id)) {
+    throw std::system_error{EPROTO, std::generic_category(), "match server"};
+  }
+  std::memcpy(&id, response.data(), sizeof(id));
+  return id;
+}
+
+bool MatchClient::match(std::uint32_t id, std::string_view string) {
+  start(MatchServer::Request::MATCH);
+  appendInteger(m_buffer, id);
+  m_buffer.insert(m_buffer.end(), string.begin(), string.end());
+  std::string_view response{exchange()};
+  if (response.size() != 1) {
+    throw std::system_error{EPROTO, std::generic_category(), "match server"};
+  }
+  return response.front() == 1;
+}
+
+void MatchClient::matchBatch(std::uint32_t id,
+                             const std::vector<std::string_view>& strings,
+                             std::vector<char>& results) {
+  start(MatchServer::Request::MATCH_BATCH);
+  appendInteger(m_buffer, id);
+  appendInteger(m_buffer, static_cast<std::uint32_t>(strings.size()));
+  for (auto string: strings) {
+    appendInteger(m_buffer, static_cast<std::uint32_t>(string.size()));
+    m_buffer.insert(m_buffer.end(), string.begin(), string.end());
+  }
+  std::string_view response{exchange()};
+  if (response.size() != sizeof(std::uint32_t) + strings.size()) {
+    throw std::system_error{EPROTO, std::generic_category(), "match server"};
+  }
+  response.remove_prefix(sizeof(std::uint32_t));
+  results.insert(results.end(), response.begin(), response.end());
+}
+
+void MatchClient::release(std::uint32_t id) {
+  start(MatchServer::Request::RELEASE);
+  appendInteger(m_buffer, id);
+  exchange();
+}
+
+void MatchClient::start(MatchServer::Request request) {
+  m_buffer.assign(sizeof(std::uint32_t), 0); // The length, see exchange()
+  m_buffer.push_back(static_cast<char>(request));
+}
+
+std::string_view MatchClient::exchange() {
+  if (m_buffer.size() - sizeof(std::uint32_t) > MatchServer::MAX_FRAME) {
+    throw std::system_error{EMSGSIZE, std::generic_category(), "match server"};
+  }
+  auto length{static_cast<std::uint32_t>(m_buffer.size()
+                                         - sizeof(std::uint32_t))};
+  std::memcpy(m_buffer.data(), &length, sizeof(length));
+  transfer(m_socket, m_buffer.data(), m_buffer.size(), true);
+
+  transfer(m_socket, reinterpret_cast<char*>(&length), sizeof(length), false);
+  if (length == 0 || length > MatchServer::MAX_FRAME) {
+    throw std::system_error{EPROTO, std::generic_category(), "match server"};
+  }
+  m_buffer.resize(length);
+  transfer(m_socket, m_buffer.data(), m_buffer.size(), false);
+
+  switch (static_cast<MatchServer::Status>(m_buffer.front())) {
+  case MatchServer::Status::OK:
+    return {m_buffer.data() + 1, m_buffer.size() - 1};
+  case MatchServer::Status::UNKNOWN_EXPRESSION:
+    throw std::system_error{ENOENT, std::generic_category(),
+                            "unknown expression"};
+  case MatchServer::Status::FAILED:
+    throw std::system_error{EIO, std::generic_category(),
+                            "match server failed to answer"};
+  default:
+    throw std::system_error{EPROTO, std::generic_category(), "match server"};
+  }
+}
@@ -0,0 +1,328 @@
+/**
+ * This file contains the implementation of the MatchServer class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "MatchServer.h"
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <new>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+/**
+ * Take a 32-bit integer from the front of a request.
+ *
+ * @param request the remaining request, which is advanced past the integer
+ * @param value the integer read
+ * @return false if the request is too short, true otherwise
+ */
+bool takeInteger(std::string_view& request, std::uint32_t& value) {
+  if (request.size() < sizeof(value)) {
+    return false;
+  }
+  std::memcpy(&value, request.data(), sizeof(value));
+  request.remove_prefix(sizeof(value));
+  return true;
+}
+
+/**
+ * Append a 32-bit integer to a response.
+ *
+ * @param output the buffer to append to
+ * @param value the integer to append
+ */
+void appendInteger(std::vector<char>& output, std::uint32_t value) {
+  char bytes[sizeof(value)];
+  std::memcpy(bytes, &value, sizeof(value));
+  output.insert(output.end(), bytes, bytes + sizeof(value));
+}
+
+/**
+ * Throw the error of the last failed system call.
+ *
+ * @param what the operation that failed
+ */
+[[noreturn]] void fail(const char* what) {
+  throw std::system_error{errno, std::generic_category(), what};
+}
+} // namespace
+
+MatchServer::MatchServer(std::string path) : m_path{std::move(path)} {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (m_path.size() >= sizeof(address.sun_path)) {
+    throw std::system_error{ENAMETOOLONG, std::generic_category(), m_path};
+  }
+  std::memcpy(address.sun_path, m_path.c_str(), m_path.size() + 1);
+
+  m_listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (m_listener == -1) {
+    fail("socket");
+  }
+  if (struct stat status {};
+      ::lstat(m_path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+    // Only replace the socket if no server accepts connections on it anymore
+    int probe{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    int error{probe == -1 ? errno : 0};
+    if (probe != -1
+        && ::connect(probe, reinterpret_cast<const sockaddr*>(&address),
+                     sizeof(address))
+               == 0) {
+      error = EADDRINUSE;
+    } else if (probe != -1) {
+      error = errno == ECONNREFUSED ? 0 : errno;
+    }
+    if (probe != -1) {
+      ::close(probe);
+    }
+    if (error != 0) {
+      ::close(m_listener);
+      throw std::system_error{error, std::generic_category(), m_path};
+    }
+    ::unlink(m_path.c_str()); // Left behind by an earlier server
+  }
+  if (::bind(m_listener, reinterpret_cast<const sockaddr*>(&address),
+             sizeof(address))
+          == -1
+      || ::listen(m_listener, SOMAXCONN) == -1) {
+    int error{errno};
+    ::close(m_listener);
+    throw std::system_error{error, std::generic_category(), m_path};
+  }
+
+  m_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = m_listener;
+  if (m_epoll == -1
+      || ::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_listener, &event) == -1) {
+    int error{errno};
+    if (m_epoll != -1) {
+      ::close(m_epoll);
+    }
+    ::close(m_listener);
+    ::unlink(m_path.c_str());
+    throw std::system_error{error, std::generic_category(), "epoll"};
+  }
+}
+
+MatchServer::~MatchServer() {
+  for (const auto& [client, connection]: m_connections) {
+    ::close(client);
+  }
+  ::close(m_epoll);
+  ::close(m_listener);
+  ::unlink(m_path.c_str());
+}
+
+void MatchServer::run() {
+  std::array<epoll_event, 64> events{};
+  while (true) {
+    int ready{::epoll_wait(m_epoll, events.data(),
+                           static_cast<int>(events.size()), -1)};
+    if (ready == -1 && errno == EINTR) {
+      continue;
+    } else if (ready == -1) {
+      fail("epoll_wait");
+    }
+
+    for (int index{0}; index < ready; ++index) {
+      int descriptor{events[index].data.fd};
+      if (descriptor == m_listener) {
+        accept();
+        continue;
+      }
+
+      auto found{m_connections.find(descriptor)};
+      if (found == m_connections.end()) {
+        continue;
+      }
+      bool keep{(events[index].events & (EPOLLERR | EPOLLHUP)) == 0
+                || (events[index].events & EPOLLIN) != 0};
+      try {
+        if (keep && (events[index].events & EPOLLOUT) != 0) {
+          keep = send(descriptor, found->second);
+        }
+        if (keep && (events[index].events & EPOLLIN) != 0) {
+          keep = receive(descriptor, found->second);
+        }
+      } catch (const std::bad_alloc&) {
+        keep = false; // Requests are answered with FAILED, but not buffered
+      }
+      if (!keep) {
+        disconnect(descriptor);
+      }
+    }
+  }
+}
+
+void MatchServer::accept() {
+  while (true) {
+    int client{::accept4(m_listener, nullptr, nullptr,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC)};
+    if (client == -1 && errno == EINTR) {
+      continue;
+    } else if (client == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return;
+    } else if (client == -1 && errno == ECONNABORTED) {
+      continue;
+    } else if (client == -1) {
+      fail("accept");
+    }
+
+    try {
+      m_connections.emplace(client, Connection{});
+    } catch (const std::bad_alloc&) {
+      ::close(client);
+      continue;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = client;
+    if (::epoll_ctl(m_epoll, EPOLL_CTL_ADD, client, &event) == -1) {
+      m_connections.erase(client);
+      ::close(client);
+    }
+  }
+}
+
+bool MatchServer::receive(int client, Connection& connection) {
+  char buffer[1 << 16];
+  ssize_t received{::read(client, buffer, sizeof(buffer))};
+  if (received == -1) {
+    return errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK;
+  } else if (received == 0) {
+    return false; // The client hung up
+  }
+  connection.input.insert(connection.input.end(), buffer, buffer + received);
+
+  std::size_t consumed{0};
+  while (true) {
+    std::string_view pending{connection.input.data() + consumed,
+                             connection.input.size() - consumed};
+    std::uint32_t length{};
+    if (!takeInteger(pending, length)) {
+      break;
+    } else if (length > MAX_FRAME) {
+      return false;
+    } else if (pending.size() < length) {
+      break;
+    }
+    answer(pending.substr(0, length), connection);
+    consumed += sizeof(length) + length;
+  }
+  connection.input.erase(connection.input.begin(),
+                         connection.input.begin()
+                             + static_cast<std::ptrdiff_t>(consumed));
+  return send(client, connection);
+}
+
+bool MatchServer::send(int client, Connection& connection) {
+  while (connection.sent < connection.output.size()) {
+    ssize_t sent{::send(client, connection.output.data() + connection.sent,
+                        connection.output.size() - connection.sent,
+                        MSG_NOSIGNAL)};
+    if (sent == -1 && errno == EINTR) {
+      continue;
+    } else if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    } else if (sent == -1) {
+      return false;
+    }
+    connection.sent += static_cast<std::size_t>(sent);
+  }
+
+  // Stop reading requests while responses are pending, so a client that does
+  // not read its responses cannot make the server buffer without bound
+  bool pending{connection.sent < connection.output.size()};
+  if (!pending) {
+    connection.output.clear();
+    connection.sent = 0;
+  }
+  epoll_event event{};
+  event.events = pending ? EPOLLOUT : EPOLLIN;
+  event.data.fd = client;
+  return ::epoll_ctl(m_epoll, EPOLL_CTL_MOD, client, &event) == 0;
+}
+
+void MatchServer::answer(std::string_view request, Connection& connection) {
+  std::vector<char>& output{connection.output};
+  std::size_t frame{output.size()};
+  appendInteger(output, 0); // The length, filled in below
+  output.push_back(static_cast<char>(Status::OK));
+
+  auto status{Status::OK};
+  auto kind{request.empty() ? Request{} : static_cast<Request>(request.front())};
+  request.remove_prefix(request.empty() ? 0 : 1);
+  std::uint32_t id{};
+  try {
+    if (kind == Request::COMPILE) {
+      appendInteger(output, connection.next_id);
+      connection.expressions.emplace(connection.next_id,
+                                     RegularExpression{request});
+      ++connection.next_id;
+    } else if (kind != Request::MATCH && kind != Request::MATCH_BATCH
+               && kind != Request::RELEASE) {
+      status = Status::MALFORMED_REQUEST;
+    } else if (!takeInteger(request, id)) {
+      status = Status::MALFORMED_REQUEST;
+    } else if (auto found{connection.expressions.find(id)};
+               found == connection.expressions.end()) {
+      status = Status::UNKNOWN_EXPRESSION;
+    } else if (kind == Request::RELEASE) {
+      connection.expressions.erase(found);
+    } else if (kind == Request::MATCH) {
+      output.push_back(found->second.mat(request, m_scratch) ? 1 : 0);
+    } else {
+      std::uint32_t count{};
+      m_batch.clear();
+      bool complete{takeInteger(request, count)};
+      for (std::uint32_t string{0}; complete && string < count; ++string) {
+        std::uint32_t length{};
+        complete = takeInteger(request, length) && length <= request.size();
+        if (complete) {
+          m_batch.push_back(request.substr(0, length));
+          request.remove_prefix(length);
+        }
+      }
+
+      if (complete) {
+        m_results.clear();
+        found->second.matBatch(m_batch, m_scratch, m_results);
+        appendInteger(output, count);
+        output.insert(output.end(), m_results.begin(), m_results.end());
+      } else {
+        status = Status::MALFORMED_REQUEST;
+      }
+    }
+  } catch (const std::exception&) { // Only this request fails
+    status = Status::FAILED;
+  }
+
+  if (status != Status::OK) {
+    output.resize(frame + sizeof(std::uint32_t)); // Within the capacity
+    output.push_back(static_cast<char>(status));
+  }
+  auto length{static_cast<std::uint32_t>(output.size() - frame
+                                         - sizeof(std::uint32_t))};
+  std::memcpy(output.data() + frame, &length, sizeof(length));
+}
+
+void MatchServer::disconnect(int client) {
+  ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, client, nullptr);
+  ::close(client);
+  m_connections.erase(client);
+}
@@ -0,0 +1,170 @@
+/**
+ * This file contains the implementation of the MatchStatistics class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "MatchStatistics.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+namespace {
+/**
+ * The counters that are added up when combining statistics, which are all but
+ * the largest closure.
+ */
+constexpr std::size_t MatchStatistics::*SUMMED[]{
+    &MatchStatistics::literal_matches, &MatchStatistics::dfa_matches,
+    &MatchStatistics::nfa_matches,     &MatchStatistics::dfa_deferrals,
+    &MatchStatistics::dfa_builds,      &MatchStatistics::characters,
+    &MatchStatistics::states_visited,  &MatchStatistics::closures,
+    &MatchStatistics::allocations};
+
+/**
+ * The totals of a single thread. Only the thread itself adds to them, but
+ * other threads read and reset them, so they are atomic. The cache line they
+ * are on is only contended while the totals are requested.
+ */
+class ThreadTotals {
+public:
+  ThreadTotals();
+  ~ThreadTotals();
+  ThreadTotals(const ThreadTotals&) = delete;
+  ThreadTotals& operator=(const ThreadTotals&) = delete;
+
+  /**
+   * Add the counters of a single match.
+   *
+   * @param statistics the counters to add
+   */
+  void add(const MatchStatistics& statistics);
+
+  /**
+   * Get the totals of the thread.
+   *
+   * @return the counters recorded so far
+   */
+  [[nodiscard]] MatchStatistics get() const;
+
+  /**
+   * Set the totals of the thread back to zero.
+   */
+  void clear();
+
+private:
+  /**
+   * The counters listed in SUMMED.
+   */
+  alignas(64) std::array<std::atomic<std::size_t>, std::size(SUMMED)> m_sums{};
+
+  /**
+   * The largest closure.
+   */
+  std::atomic<std::size_t> m_max_closure{0};
+};
+
+/**
+ * The guard of the registered threads and the totals of ended threads.
+ */
+std::mutex registry_mutex{};
+
+/**
+ * The totals of the threads that are running.
+ */
+std::vector<ThreadTotals*> registry{};
+
+/**
+ * The totals of the threads that have ended.
+ */
+MatchStatistics retired{};
+
+ThreadTotals::ThreadTotals() {
+  std::lock_guard<std::mutex> lock{registry_mutex};
+  registry.push_back(this);
+}
+
+ThreadTotals::~ThreadTotals() {
+  std::lock_guard<std::mutex> lock{registry_mutex};
+  retired.merge(get());
+  registry.erase(std::find(registry.begin(), registry.end(), this));
+}
+
+void ThreadTotals::add(const MatchStatistics& statistics) {
+  for (std::size_t index{0}; index < m_sums.size(); ++index) {
+    m_sums[index].fetch_add(statistics.*SUMMED[index],
+                            std::memory_order_relaxed);
+  }
+  std::size_t max_closure{m_max_closure.load(std::memory_order_relaxed)};
+  while (statistics.max_closure > max_closure
+         && !m_max_closure.compare_exchange_weak(max_closure,
+                                                 statistics.max_closure,
+                                                 std::memory_order_relaxed)) {
+  }
+}
+
+MatchStatistics ThreadTotals::get() const {
+  MatchStatistics statistics{};
+  for (std::size_t index{0}; index < m_sums.size(); ++index) {
+    statistics.*SUMMED[index] = m_sums[index].load(std::memory_order_relaxed);
+  }
+  statistics.max_closure = m_max_closure.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+void ThreadTotals::clear() {
+  for (auto& sum: m_sums) {
+    sum.store(0, std::memory_order_relaxed);
+  }
+  m_max_closure.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * Get the totals of the calling thread, registering them on first use.
+ *
+ * @return the totals of the calling thread
+ */
+ThreadTotals& threadTotals() {
+  thread_local ThreadTotals totals{};
+  return totals;
+}
+} // namespace
+
+void MatchStatistics::closure(std::size_t size) {
+  ++closures;
+  states_visited += size;
+  max_closure = std::max(max_closure, size);
+}
+
+void MatchStatistics::record(const MatchStatistics& statistics) {
+  threadTotals().add(statistics);
+}
+
+MatchStatistics MatchStatistics::total() {
+  std::lock_guard<std::mutex> lock{registry_mutex};
+  MatchStatistics statistics{retired};
+  for (const auto* totals: registry) {
+    statistics.merge(totals->get());
+  }
+  return statistics;
+}
+
+void MatchStatistics::reset() {
+  std::lock_guard<std::mutex> lock{registry_mutex};
+  retired = MatchStatistics{};
+  for (auto* totals: registry) {
+    totals->clear();
+  }
+}
+
+void MatchStatistics::merge(const MatchStatistics& statistics) {
+  for (auto field: SUMMED) {
+    this->*field += statistics.*field;
+  }
+  max_closure = std::max(max_closure, statistics.max_closure);
+}
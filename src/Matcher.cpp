@@ -0,0 +1,68 @@
+/**
+ * This file contains the implementation of the Matcher class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "Matcher.h"
+
+Matcher::Matcher(const RegularExpression& expression)
+    : m_expression{expression},
+      m_dfa{expression.m_literals ? nullptr : expression.dfa()} {
+  reset();
+}
+
+void Matcher::feed(std::string_view chunk) {
+  if (chunk.empty()) {
+    return;
+  }
+  m_empty = false;
+  REGEXP_COUNT(m_scratch.m_statistics.characters += chunk.size());
+
+  if (m_expression.m_automaton.empty()) {
+    return; // Only the empty string is accepted, which m_empty tracks
+  } else if (m_expression.m_literals) {
+    if (m_state != -1) {
+      m_state = m_expression.m_literals->walk(m_state, chunk);
+    }
+  } else if (m_dfa != nullptr) {
+    m_state = m_dfa->run(m_state, chunk);
+  } else {
+    m_expression.continueSimulation(chunk, m_scratch);
+  }
+}
+
+bool Matcher::finish() {
+  bool match{};
+  if (m_expression.m_automaton.empty()) {
+    match = m_empty;
+  } else if (m_expression.m_literals) {
+    REGEXP_COUNT(++m_scratch.m_statistics.literal_matches);
+    match = m_state != -1 && m_expression.m_literals->accepting(m_state);
+  } else if (m_dfa != nullptr) {
+    REGEXP_COUNT(++m_scratch.m_statistics.dfa_matches);
+    match = m_dfa->accepting(m_state);
+  } else {
+    REGEXP_COUNT(++m_scratch.m_statistics.nfa_matches);
+    match = m_expression.accepted(m_scratch);
+  }
+
+  REGEXP_COUNT(RegularExpression::recordStatistics(m_scratch));
+  reset();
+  return match;
+}
+
+void Matcher::reset() {
+  m_empty = true;
+  if (m_expression.m_automaton.empty()) {
+    return;
+  } else if (m_expression.m_literals) {
+    m_state = AhoCorasick::ROOT;
+  } else if (m_dfa != nullptr) {
+    m_state = m_dfa->initialState();
+  } else {
+    m_expression.startSimulation(m_scratch);
+  }
+}
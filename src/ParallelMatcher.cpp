@@ -0,0 +1,42 @@
+/**
+ * This file contains the implementation of the ParallelMatcher class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "ParallelMatcher.h"
+#include "WorkStealingScheduler.h"
+#include <algorithm>
+#include <vector>
+
+ParallelMatcher::ParallelMatcher(const Dfa& dfa, unsigned threads)
+    : m_dfa{dfa}, m_threads{std::max(threads, 1U)} {}
+
+bool ParallelMatcher::mat(std::string_view string) const {
+  std::size_t chunk_size{
+      std::max<std::size_t>(string.size() / (m_threads * 4), 1 << 20)};
+  std::size_t chunks{(string.size() + chunk_size - 1) / chunk_size};
+  if (chunks <= 1) {
+    return m_dfa.accepting(m_dfa.run(m_dfa.initialState(), string));
+  }
+
+  int first_state{};
+  std::vector<std::vector<int>> transfers(chunks);
+  WorkStealingScheduler{m_threads}.run(
+      chunks, [&](std::size_t chunk, unsigned) {
+        std::string_view part{string.substr(chunk * chunk_size, chunk_size)};
+        if (chunk == 0) { // Only the initial state is possible here
+          first_state = m_dfa.run(m_dfa.initialState(), part);
+        } else {
+          transfers[chunk] = m_dfa.transfer(part);
+        }
+      });
+
+  int state{first_state};
+  for (std::size_t chunk{1}; chunk < chunks; ++chunk) {
+    state = transfers[chunk][state];
+  }
+  return m_dfa.accepting(state);
+}
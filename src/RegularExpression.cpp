@@ -7,179 +7,509 @@
  */
 
 #include "RegularExpression.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
 #include <iterator>
-#include <set>
 #include <sstream>
+#include <utility>
 #include <vector>
 
-RegularExpression::RegularExpression(std::string_view expression) {
-  std::istringstream inputStream{expression.data()};
-  int next_index{0};
+namespace {
+/**
+ * A memory resource passing allocations on to another one while counting the
+ * bytes allocated.
+ */
+class CountingResource : public std::pmr::memory_resource {
+public:
+  /**
+   * Construct a resource allocating from the given one.
+   *
+   * @param upstream the resource to allocate from
+   */
+  explicit CountingResource(std::pmr::memory_resource* upstream)
+      : m_upstream{upstream} {}
+
+  /**
+   * Get the number of bytes allocated so far.
+   *
+   * @return the number of bytes, including those deallocated since
+   */
+  [[nodiscard]] std::size_t allocated() const {
+    return m_allocated;
+  }
+
+private:
+  std::pmr::memory_resource* m_upstream;
+  std::size_t m_allocated{0};
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    void* memory{m_upstream->allocate(bytes, alignment)};
+    m_allocated += bytes;
+    return memory;
+  }
+
+  void do_deallocate(void* memory, std::size_t bytes,
+                     std::size_t alignment) override {
+    m_upstream->deallocate(memory, bytes, alignment);
+  }
+
+  [[nodiscard]] bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+} // namespace
+
+RegularExpression::RegularExpression(std::string_view expression,
+                                     std::pmr::memory_resource* resource) {
+  auto start{std::chrono::steady_clock::now()};
+  std::array<std::byte, ARENA_SIZE> buffer; // Left uninitialized for the arena
+  std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(),
+                                            resource};
+  CountingResource counted{&arena};
+  std::string_view remaining{expression};
   int start_index{0};
-  m_automaton = expr(inputStream, next_index, start_index);
+  m_automaton.reserve(2 * expression.size()); // Two states per character
+  expr(remaining, m_automaton, start_index, m_profile.copied_bytes, &counted);
+  m_profile.arena_bytes = counted.allocated();
+  m_profile.automaton_bytes = m_automaton.capacity() * sizeof(State);
   m_initial_state = start_index;
+  if (!m_automaton.empty()) {
+    m_final_states.push_back(static_cast<int>(m_automaton.size() - 1));
+  }
+  m_profile.epsilon_states = static_cast<std::size_t>(
+      std::count_if(m_automaton.begin(), m_automaton.end(),
+                    [](const State& state) { return state.character == '\0'; }));
+  auto parsed{std::chrono::steady_clock::now()};
+
+  // Single strings are matched with the literals, but the automaton is still
+  // needed for dot() and for the DFA used by batches and huge strings
+  if (std::vector<std::string_view> words{}; splitWords(expression, words)) {
+    std::vector<std::pair<std::string_view, int>> literals{};
+    for (auto word: words) {
+      literals.emplace_back(word, 0);
+    }
+    m_literals.emplace(literals);
+  }
+  m_dfa = std::make_shared<LazyDfa>();
+  auto built{std::chrono::steady_clock::now()};
+  m_profile.parse_seconds = std::chrono::duration<double>{parsed - start}
+                                .count();
+  m_profile.build_seconds = std::chrono::duration<double>{built - parsed}
+                                .count();
+}
+
+RegularExpression::RegularExpression(std::vector<State> automaton,
+                                     int initial_state,
+                                     std::vector<int> final_states,
+                                     std::size_t state_limit)
+    : m_automaton{std::move(automaton)}, m_initial_state{initial_state},
+      m_final_states{std::move(final_states)},
+      m_dfa{std::make_shared<LazyDfa>()} {
+  m_dfa->state_limit = state_limit;
 }
 
 std::string RegularExpression::dot() const {
-  std::ostringstream ss;
-  ss << "digraph {\n"
-     << "\trankdir = LR\n"
-     << "\tnode [shape = circle, style = filled, fillcolor = gray93]\n"
-     << "\t" << (m_automaton.empty() ? 1 : m_automaton.size())
-     << " [shape = doublecircle]\n"
-     << "\t0 [style = invisible]\n"
-     << "\t0 -> " << m_initial_state + 1 << '\n';
-  std::string output{ss.str()};
+  std::ostringstream output;
+  dot(output);
+  return output.str();
+}
+
+void RegularExpression::dot(std::ostream& output) const {
+  output << dotHeader();
 
+  std::array<char, 1 << 16> buffer{};
+  char* position{buffer.data()};
   int state_number{1};
   for (const auto& state: m_automaton) {
-    if (state.first_outgoing != -1) {
-      output += dotState(state_number, state, true);
-    }
-    if (state.second_outgoing != -1) {
-      output += dotState(state_number, state, false);
+    if (buffer.data() + buffer.size() - position < DOT_STATE_SIZE) {
+      output.write(buffer.data(), position - buffer.data());
+      position = buffer.data();
     }
-    ++state_number;
+    position = dotState(position, state_number++, state);
   }
+  output.write(buffer.data(), position - buffer.data());
+  output << '}';
+}
 
-  output.append("}");
-  return output;
+std::string RegularExpression::dotHeader() const {
+  return "digraph {\n"
+         "\trankdir = LR\n"
+         "\tnode [shape = circle, style = filled, fillcolor = gray93]\n"
+         "\t"
+         + std::to_string(m_automaton.empty() ? 1 : m_automaton.size())
+         + " [shape = doublecircle]\n"
+           "\t0 [style = invisible]\n"
+           "\t0 -> "
+         + std::to_string(m_initial_state + 1) + '\n';
 }
 
-std::string RegularExpression::dotState(
-    int state_number, const RegularExpression::State& state, bool first_edge) {
-  return '\t' + std::to_string(state_number) + " -> "
-         + (first_edge ? std::to_string(state.first_outgoing + 1)
-                       : std::to_string(state.second_outgoing + 1))
-         + " [label=\""
-         + (std::islower(state.character) ? std::string{state.character}
-                                          : "&epsilon;")
-         + "\"]\n";
+char* RegularExpression::dotState(char* position, int state_number,
+                                  const RegularExpression::State& state) {
+  auto edge{[&](int target) {
+    *position++ = '\t';
+    position = std::to_chars(position, position + 11, state_number).ptr;
+    position = std::copy_n(" -> ", 4, position);
+    position = std::to_chars(position, position + 11, target + 1).ptr;
+    position = std::copy_n(" [label=\"", 9, position);
+    if (std::islower(state.character)) {
+      *position++ = state.character;
+    } else {
+      position = std::copy_n("&epsilon;", 9, position);
+    }
+    position = std::copy_n("\"]\n", 3, position);
+  }};
+
+  if (state.first_outgoing != -1) {
+    edge(state.first_outgoing);
+  }
+  if (state.second_outgoing != -1) {
+    edge(state.second_outgoing);
+  }
+  return position;
 }
 
 bool RegularExpression::mat(std::string_view string) const {
-  std::string string_to_match{string == "$" ? "" : string}; // $ = empty string
-  if (m_automaton.empty() && (!string_to_match.empty())) {
-    return false;
-  } else if (m_automaton.empty()) {
-    return true;
-  }
-
-  std::set<int> current_states{traverseEmptyTransitions({m_initial_state})};
-  for (auto character: string_to_match) {
-    std::set<int> new_states{};
-    for (auto state: current_states) {
-      if (m_automaton[state].character == character) {
-        new_states.insert(m_automaton[state].first_outgoing);
+  Scratch scratch{};
+  return mat(string, scratch);
+}
+
+bool RegularExpression::mat(std::string_view string, Scratch& scratch) const {
+  std::string_view string_to_match{string == "$" ? "" : string}; // $ = empty
+  REGEXP_COUNT(scratch.m_statistics.characters += string_to_match.size());
+  bool match{};
+  if (m_automaton.empty()) {
+    match = string_to_match.empty();
+  } else if (m_literals) {
+    REGEXP_COUNT(++scratch.m_statistics.literal_matches);
+    match = m_literals->accepts(string_to_match);
+  } else if (const Dfa* dfa{dfaFor(string_to_match.size())}; dfa != nullptr) {
+    REGEXP_COUNT(++scratch.m_statistics.dfa_matches);
+    match = dfa->accepting(dfa->run(dfa->initialState(), string_to_match));
+  } else {
+    REGEXP_COUNT(++scratch.m_statistics.nfa_matches);
+    REGEXP_COUNT(scratch.m_statistics.dfa_deferrals +=
+                 m_dfa && !m_dfa->built.load(std::memory_order_acquire));
+    simulate(string_to_match, scratch);
+    match = accepted(scratch);
+  }
+
+  REGEXP_COUNT(recordStatistics(scratch));
+  return match;
+}
+
+void RegularExpression::matBatch(const std::vector<std::string_view>& strings,
+                                 Scratch& scratch,
+                                 std::vector<char>& results) const {
+  const Dfa* dfa{this->dfa()};
+  if (dfa == nullptr) {
+    for (auto string: strings) {
+      results.push_back(mat(string, scratch) ? 1 : 0);
+    }
+    return;
+  }
+
+  scratch.m_batch_strings.clear();
+  for (auto string: strings) {
+    scratch.m_batch_strings.push_back(string == "$" ? "" : string); // $ = empty
+    REGEXP_COUNT(scratch.m_statistics.characters +=
+                 scratch.m_batch_strings.back().size());
+  }
+  REGEXP_COUNT(scratch.m_statistics.dfa_matches += strings.size());
+  scratch.m_batch_states.resize(strings.size());
+  dfa->runBatch(scratch.m_batch_strings.data(), strings.size(),
+                scratch.m_batch_states.data());
+  for (auto state: scratch.m_batch_states) {
+    results.push_back(dfa->accepting(state) ? 1 : 0);
+  }
+  REGEXP_COUNT(recordStatistics(scratch));
+}
+
+void RegularExpression::simulate(std::string_view string,
+                                 Scratch& scratch) const {
+  startSimulation(scratch);
+  continueSimulation(string, scratch);
+}
+
+void RegularExpression::startSimulation(Scratch& scratch) const {
+  if (scratch.m_marks.size() < m_automaton.size()) {
+    scratch.m_marks.assign(m_automaton.size(), 0);
+    scratch.m_generation = 0;
+    scratch.m_current_states.reserve(m_automaton.size());
+    scratch.m_next_states.reserve(m_automaton.size());
+    scratch.m_pending_states.reserve(2 * m_automaton.size());
+    REGEXP_COUNT(scratch.m_statistics.allocations += 4);
+  }
+
+  beginStates(scratch);
+  scratch.m_current_states.clear();
+  traverseEmptyTransitions(m_initial_state, scratch, scratch.m_current_states);
+  REGEXP_COUNT(scratch.m_statistics.closure(scratch.m_current_states.size()));
+}
+
+void RegularExpression::continueSimulation(std::string_view string,
+                                           Scratch& scratch) const {
+  for (auto character: string) {
+    if (scratch.m_current_states.empty()) { // No state can become active again
+      return;
+    }
+    beginStates(scratch);
+    scratch.m_next_states.clear();
+    for (auto state: scratch.m_current_states) {
+      if (m_automaton[state].character != '\0'
+          && m_automaton[state].character == character) {
+        traverseEmptyTransitions(m_automaton[state].first_outgoing, scratch,
+                                 scratch.m_next_states);
       }
     }
-    current_states = traverseEmptyTransitions(new_states);
+    scratch.m_current_states.swap(scratch.m_next_states);
+    REGEXP_COUNT(scratch.m_statistics.closure(scratch.m_current_states.size()));
   }
-  // Final state is always the last state due to the parser implementation
-  return current_states.count(static_cast<int>(m_automaton.size() - 1)) == 1;
 }
 
-std::set<int> RegularExpression::traverseEmptyTransitions(
-    const std::set<int>& current_states) const {
-  std::set<int> new_states{};
-  return traverseEmptyTransitionsRecursive(current_states, new_states);
+bool RegularExpression::accepted(const Scratch& scratch) const {
+  return std::any_of(m_final_states.begin(), m_final_states.end(),
+                     [&](int state) {
+                       return scratch.m_marks[state] == scratch.m_generation;
+                     });
 }
 
-std::set<int> RegularExpression::traverseEmptyTransitionsRecursive(
-    const std::set<int>& current_states, std::set<int>& new_states) const {
-  for (auto state: current_states) {
-    new_states.insert(state);
-    if (m_automaton[state].character == '\0') {
-      if (m_automaton[state].first_outgoing != -1
-          && new_states.count(m_automaton[state].first_outgoing) == 0) {
-        new_states.merge(traverseEmptyTransitionsRecursive(
-            std::set<int>{m_automaton[state].first_outgoing}, new_states));
+#ifdef REGEXP_STATISTICS
+void RegularExpression::recordStatistics(Scratch& scratch) {
+  MatchStatistics::record(scratch.m_statistics);
+  scratch.m_statistics = MatchStatistics{};
+}
+#endif
+
+bool RegularExpression::splitWords(std::string_view expression,
+                                   std::vector<std::string_view>& words) {
+  std::size_t word_start{0};
+  for (std::size_t index{0}; index <= expression.size(); ++index) {
+    if (index == expression.size() || expression[index] == '|') {
+      if (index == word_start) {
+        return false; // Empty alternative
       }
-      if (m_automaton[state].second_outgoing != -1
-          && new_states.count(m_automaton[state].second_outgoing) == 0) {
-        new_states.merge(traverseEmptyTransitionsRecursive(
-            std::set<int>{m_automaton[state].second_outgoing}, new_states));
+      words.push_back(expression.substr(word_start, index - word_start));
+      word_start = index + 1;
+    } else {
+      auto character{static_cast<unsigned char>(expression[index])};
+      if (index == word_start ? !std::isalpha(character)
+                              : !std::islower(character)) {
+        return false;
       }
     }
   }
+  return true;
+}
 
-  return new_states;
+std::size_t RegularExpression::states() const {
+  return m_automaton.size();
 }
 
-// ⟨expr⟩ := ⟨term⟩ [ | ⟨expr⟩ ]
-std::vector<RegularExpression::State> RegularExpression::expr(
-    std::istringstream& expression, int& next_index, int& start_index) {
-  std::vector<State> automaton{term(expression, next_index, start_index)};
-  int front_index{start_index};
-
-  if (expression.peek() == '|') {
-    expression.get();
-
-    std::vector<State> automaton_alternative{expr(expression, next_index,
-                                                  start_index)};
-    int alternative_front_index{start_index};
-
-    automaton.back().first_outgoing = next_index + 1;
-    automaton_alternative.back().first_outgoing = next_index + 1;
-    automaton.insert(automaton.end(), automaton_alternative.begin(),
-                     automaton_alternative.end());
-    automaton.emplace_back(State{'\0', front_index, alternative_front_index});
-    start_index = next_index;
-    automaton.emplace_back(State{});
-    next_index += 2;
+const Dfa* RegularExpression::dfa() const {
+  if (!m_dfa) {
+    return nullptr;
   }
 
-  return automaton;
+  std::call_once(m_dfa->once, [this] {
+    auto start{std::chrono::steady_clock::now()};
+    m_dfa->dfa = Dfa::build(*this, m_dfa->state_limit);
+    m_dfa->build_seconds = std::chrono::duration<double>{
+        std::chrono::steady_clock::now() - start}.count();
+    m_dfa->built.store(true, std::memory_order_release);
+    REGEXP_COUNT(MatchStatistics built{});
+    REGEXP_COUNT(built.dfa_builds = 1);
+    REGEXP_COUNT(MatchStatistics::record(built));
+  });
+  return m_dfa->dfa ? &*m_dfa->dfa : nullptr;
 }
 
-// ⟨term⟩ := ⟨fact⟩ [ ⟨term⟩ ]
-std::vector<RegularExpression::State> RegularExpression::term(
-    std::istringstream& expression, int& next_index, int& start_index) {
-  std::vector<State> automaton{fact(expression, next_index, start_index)};
-  int front_index{start_index};
-
-  if (expression.peek() == '(' || std::islower(expression.peek())) {
-    std::vector<State> automaton_concatenation{term(expression, next_index,
-                                                    start_index)};
-    automaton.back().first_outgoing = start_index;
-    automaton.insert(automaton.end(), automaton_concatenation.begin(),
-                     automaton_concatenation.end());
-    start_index = front_index;
+RegularExpression::Profile RegularExpression::profile() const {
+  Profile profile{m_profile};
+  if (m_dfa && m_dfa->built.load(std::memory_order_acquire)) {
+    profile.build_seconds += m_dfa->build_seconds;
+  }
+  return profile;
+}
+
+const Dfa* RegularExpression::dfaFor(std::size_t bytes) const {
+  if (!m_dfa) {
+    return nullptr;
+  } else if (!m_dfa->built.load(std::memory_order_acquire)
+             && m_dfa->simulated_bytes.fetch_add(bytes,
+                                                 std::memory_order_relaxed)
+                        + bytes
+                    < LAZY_DFA_BYTES) {
+    return nullptr; // Deriving the DFA would not pay off yet
   }
+  return dfa();
+}
 
-  return automaton;
+void RegularExpression::beginStates(Scratch& scratch) const {
+  if (++scratch.m_generation == 0) { // Marks of old generations may collide
+    std::fill(scratch.m_marks.begin(), scratch.m_marks.end(), 0);
+    scratch.m_generation = 1;
+  }
 }
 
+void RegularExpression::traverseEmptyTransitions(
+    int state, Scratch& scratch, std::vector<int>& states) const {
+  scratch.m_pending_states.clear();
+  scratch.m_pending_states.push_back(state);
+  while (!scratch.m_pending_states.empty()) {
+    int current{scratch.m_pending_states.back()};
+    scratch.m_pending_states.pop_back();
+    if (current == -1 || scratch.m_marks[current] == scratch.m_generation) {
+      continue;
+    }
+
+    scratch.m_marks[current] = scratch.m_generation;
+    states.push_back(current);
+    if (m_automaton[current].character == '\0') {
+      scratch.m_pending_states.push_back(m_automaton[current].second_outgoing);
+      scratch.m_pending_states.push_back(m_automaton[current].first_outgoing);
+    }
+  }
+}
+
+// ⟨expr⟩ := ⟨term⟩ [ | ⟨expr⟩ ]
+// ⟨term⟩ := ⟨fact⟩ [ ⟨term⟩ ]
 // ⟨fact⟩ := ⟨lett⟩ [ * ] | ( ⟨expr⟩ ) [ * ]
 // ⟨lett⟩ := A | B | · · · | Z | a | b | · · · | z
-std::vector<RegularExpression::State> RegularExpression::fact(
-    std::istringstream& expression, int& next_index, int& start_index) {
-  std::vector<State> automaton{};
-  if (expression.peek() == '(' || std::isalpha(expression.peek())) {
-    if (expression.peek() == '(') {
-      expression.get();
-      automaton = expr(expression, next_index, start_index);
-      expression.get(); // Right-parenthesis
-    } else if (std::isalpha(expression.peek())) {
-      automaton.emplace_back(State{static_cast<char>(expression.get()),
-                                   next_index + 1});
+void RegularExpression::expr(std::string_view& expression,
+                             std::vector<State>& automaton, int& start_index,
+                             std::size_t& copied_bytes,
+                             std::pmr::memory_resource* arena) {
+  // The innermost level is the ⟨expr⟩ being read; the alternatives of every
+  // level wait here, innermost last, until their ⟨expr⟩ ends
+  std::pmr::vector<Level> levels{arena};
+  std::pmr::vector<int> front_indices{arena};
+  std::pmr::vector<std::size_t> back_positions{arena};
+  levels.push_back(Level{automaton.size(), automaton.size()});
+
+  while (true) {
+    Level& level{levels.back()};
+    int next{peek(expression)};
+    if (next == '(') { // Read the group as a level of its own
+      take(expression);
+      levels.push_back(Level{automaton.size(), automaton.size(),
+                             front_indices.size()});
+      continue;
+    } else if (level.term_empty ? std::isalpha(next) : std::islower(next)) {
+      int next_index{static_cast<int>(automaton.size())};
+      emit(automaton, State{static_cast<char>(take(expression)), next_index + 1},
+           copied_bytes);
       start_index = next_index;
-      automaton.emplace_back(State{});
-      next_index += 2;
-    }
+      emit(automaton, State{}, copied_bytes);
+      star(expression, automaton, start_index, copied_bytes);
+    } else {
+      // The ⟨term⟩ ended, so it is an alternative if a '|' precedes or follows
+      if (!level.term_empty) {
+        start_index = level.term_front_index;
+      }
+      if (front_indices.size() > level.first_alternative || next == '|') {
+        epsilon(automaton, level.alternative_position, start_index,
+                copied_bytes);
+        front_indices.push_back(start_index);
+        back_positions.push_back(automaton.size() - 1);
+      }
+      if (next == '|') {
+        take(expression);
+        level.alternative_position = automaton.size();
+        level.term_empty = true;
+        continue;
+      }
 
-    if (expression.peek() == '*') {
-      expression.get();
+      // The ⟨expr⟩ ended, so join its alternatives from the last one outwards,
+      // as the grammar nests them
+      if (front_indices.size() > level.first_alternative) {
+        int alternative_front_index{front_indices.back()};
+        std::size_t alternative_back_position{back_positions.back()};
+        for (std::size_t alternative{front_indices.size() - 1};
+             alternative-- > level.first_alternative;) {
+          int next_index{static_cast<int>(automaton.size())};
+          automaton[back_positions[alternative]].first_outgoing = next_index + 1;
+          automaton[alternative_back_position].first_outgoing = next_index + 1;
+          emit(automaton,
+               State{'\0', front_indices[alternative], alternative_front_index},
+               copied_bytes);
+          alternative_front_index = next_index;
+          emit(automaton, State{}, copied_bytes);
+          alternative_back_position = automaton.size() - 1;
+        }
+        start_index = alternative_front_index;
+        front_indices.resize(level.first_alternative);
+        back_positions.resize(level.first_alternative);
+      }
 
-      automaton.back().first_outgoing = start_index;
-      automaton.back().second_outgoing = next_index + 1;
+      std::size_t group_position{level.group_position};
+      levels.pop_back();
+      if (levels.empty()) {
+        return;
+      }
+      take(expression); // Right-parenthesis
+      epsilon(automaton, group_position, start_index, copied_bytes);
+      star(expression, automaton, start_index, copied_bytes);
+    }
 
-      automaton.emplace_back(State{'\0', start_index, next_index + 1});
-      start_index = next_index;
-      automaton.emplace_back(State{});
-      next_index += 2;
+    // Append the ⟨fact⟩ that was read to the ⟨term⟩ of its level
+    Level& term_level{levels.back()};
+    if (term_level.term_empty) {
+      term_level.term_front_index = start_index;
+      term_level.term_empty = false;
+    } else {
+      automaton[term_level.term_back_position].first_outgoing = start_index;
     }
+    term_level.term_back_position = automaton.size() - 1;
   }
+}
+
+void RegularExpression::star(std::string_view& expression,
+                             std::vector<State>& automaton, int& start_index,
+                             std::size_t& copied_bytes) {
+  if (peek(expression) == '*') {
+    take(expression);
+
+    int next_index{static_cast<int>(automaton.size())};
+    automaton.back().first_outgoing = start_index;
+    automaton.back().second_outgoing = next_index + 1;
 
-  return automaton;
+    emit(automaton, State{'\0', start_index, next_index + 1}, copied_bytes);
+    start_index = next_index;
+    emit(automaton, State{}, copied_bytes);
+  }
+}
+
+void RegularExpression::epsilon(std::vector<State>& automaton,
+                                std::size_t position, int& start_index,
+                                std::size_t& copied_bytes) {
+  if (automaton.size() == position) {
+    start_index = static_cast<int>(position);
+    emit(automaton, State{}, copied_bytes);
+  }
+}
+
+int RegularExpression::peek(std::string_view expression) {
+  return expression.empty() ? EOF
+                            : static_cast<unsigned char>(expression.front());
+}
+
+int RegularExpression::take(std::string_view& expression) {
+  int character{peek(expression)};
+  if (!expression.empty()) {
+    expression.remove_prefix(1);
+  }
+  return character;
+}
+
+void RegularExpression::emit(std::vector<State>& automaton, State state,
+                             std::size_t& copied_bytes) {
+  if (automaton.size() == automaton.capacity()) {
+    copied_bytes += automaton.size() * sizeof(State);
+  }
+  automaton.push_back(state);
 }
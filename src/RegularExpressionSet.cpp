@@ -0,0 +1,180 @@
+/**
+ * This file contains the implementation of the RegularExpressionSet class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "RegularExpressionSet.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <utility>
+
+RegularExpressionSet::RegularExpressionSet(
+    const std::vector<std::string>& expressions)
+    : m_size{expressions.size()} {
+  if (expressions.empty()) {
+    return;
+  }
+
+  std::vector<std::pair<std::string_view, int>> literals{};
+  for (std::size_t expression{0}; expression < expressions.size();
+       ++expression) {
+    std::vector<std::string_view> words{};
+    if (!RegularExpression::splitWords(expressions[expression], words)) {
+      literals.clear();
+      break;
+    }
+    for (auto word: words) {
+      literals.emplace_back(word, static_cast<int>(expression));
+    }
+  }
+  if (!literals.empty()) {
+    m_literals.emplace(literals);
+    if (literals.size() <= Teddy::MAX_LITERALS) {
+      m_prefilter.emplace(literals);
+    }
+    return;
+  }
+
+  std::vector<RegularExpression::State> automaton{};
+  std::vector<int> initial_states{};
+  std::vector<int> final_states{};
+
+  // Every expression is parsed in the same arena, emptied in between
+  std::array<std::byte, RegularExpression::ARENA_SIZE> buffer;
+  std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size()};
+  for (const auto& expression: expressions) {
+    arena.release(); // The previous expression only left its states behind
+    std::string_view remaining{expression};
+    std::size_t front_position{automaton.size()};
+    int start_index{0};
+    std::size_t copied_bytes{0};
+    RegularExpression::expr(remaining, automaton, start_index, copied_bytes,
+                            &arena);
+    RegularExpression::epsilon(automaton, front_position, start_index,
+                               copied_bytes); // Only accepts the empty string
+
+    initial_states.push_back(start_index);
+    final_states.push_back(static_cast<int>(automaton.size() - 1));
+  }
+
+  // Join the initial states pairwise until a single shared one remains
+  while (initial_states.size() > 1) {
+    std::vector<int> joined_states{};
+    for (std::size_t index{0}; index + 1 < initial_states.size(); index += 2) {
+      joined_states.push_back(static_cast<int>(automaton.size()));
+      automaton.emplace_back(RegularExpression::State{
+          '\0', initial_states[index], initial_states[index + 1]});
+    }
+    if (initial_states.size() % 2 == 1) {
+      joined_states.push_back(initial_states.back());
+    }
+    initial_states.swap(joined_states);
+  }
+
+  m_expression_of.assign(automaton.size(), -1);
+  for (std::size_t expression{0}; expression < final_states.size();
+       ++expression) {
+    m_expression_of[final_states[expression]] = static_cast<int>(expression);
+  }
+  m_combined = RegularExpression{std::move(automaton), initial_states.front(),
+                                 std::move(final_states), STATE_LIMIT};
+}
+
+std::vector<int> RegularExpressionSet::matches(std::string_view string) const {
+  RegularExpression::Scratch scratch{};
+  return matches(string, scratch);
+}
+
+std::vector<int> RegularExpressionSet::matches(
+    std::string_view string, RegularExpression::Scratch& scratch) const {
+  std::string_view string_to_match{string == "$" ? "" : string}; // $ = empty
+  REGEXP_COUNT(scratch.m_statistics.characters += string_to_match.size());
+  std::vector<int> result{};
+  if (m_literals) {
+    REGEXP_COUNT(++scratch.m_statistics.literal_matches);
+    result = m_literals->matchWhole(string_to_match);
+  } else if (m_combined.m_automaton.empty()) {
+    // No expressions were read, so none of them accepts the string
+  } else if (const Dfa* dfa{m_combined.dfa()}; dfa != nullptr) {
+    REGEXP_COUNT(++scratch.m_statistics.dfa_matches);
+    result = dfa->tags(dfa->run(dfa->initialState(), string_to_match));
+  } else {
+    REGEXP_COUNT(++scratch.m_statistics.nfa_matches);
+    m_combined.simulate(string_to_match, scratch);
+    for (auto state: scratch.m_current_states) {
+      if (m_expression_of[state] != -1) {
+        result.push_back(m_expression_of[state]);
+      }
+    }
+    std::sort(result.begin(), result.end());
+  }
+
+  REGEXP_COUNT(RegularExpression::recordStatistics(scratch));
+  return result;
+}
+
+std::vector<int> RegularExpressionSet::search(std::string_view string) const {
+  std::string_view string_to_search{string == "$" ? "" : string}; // $ = empty
+  if (m_prefilter) {
+    return m_prefilter->search(string_to_search);
+  } else if (m_literals) {
+    return m_literals->search(string_to_search);
+  } else if (m_combined.m_automaton.empty()) {
+    return {};
+  }
+
+  // Simulate the combined automaton while starting anew at every position
+  RegularExpression::Scratch scratch{};
+  scratch.m_marks.assign(m_combined.m_automaton.size(), 0);
+  std::vector<char> found(m_size, 0);
+  std::size_t missing{m_size};
+  auto report{[&] {
+    for (auto state: scratch.m_current_states) {
+      if (int expression{m_expression_of[state]};
+          expression != -1 && found[expression] == 0) {
+        found[expression] = 1;
+        --missing;
+      }
+    }
+  }};
+
+  m_combined.beginStates(scratch);
+  m_combined.traverseEmptyTransitions(m_combined.m_initial_state, scratch,
+                                      scratch.m_current_states);
+  report();
+  for (auto character: string_to_search) {
+    if (missing == 0) { // Every expression has been found, nothing can change
+      break;
+    }
+    m_combined.beginStates(scratch);
+    scratch.m_next_states.clear();
+    for (auto state: scratch.m_current_states) {
+      const auto& current{m_combined.m_automaton[state]};
+      if (current.character != '\0' && current.character == character) {
+        m_combined.traverseEmptyTransitions(current.first_outgoing, scratch,
+                                            scratch.m_next_states);
+      }
+    }
+    m_combined.traverseEmptyTransitions(m_combined.m_initial_state, scratch,
+                                        scratch.m_next_states);
+    scratch.m_current_states.swap(scratch.m_next_states);
+    report();
+  }
+
+  std::vector<int> result{};
+  for (std::size_t expression{0}; expression < m_size; ++expression) {
+    if (found[expression] == 1) {
+      result.push_back(static_cast<int>(expression));
+    }
+  }
+  return result;
+}
+
+std::size_t RegularExpressionSet::size() const {
+  return m_size;
+}
@@ -0,0 +1,231 @@
+/**
+ * This file contains the implementation of the Teddy class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "Teddy.h"
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define REGEXP_TEDDY_X86
+#include <immintrin.h>
+#endif
+
+Teddy::Teddy(const std::vector<std::pair<std::string_view, int>>& literals) {
+  m_fingerprint_length = 3;
+  for (const auto& [literal, tag]: literals) {
+    m_fingerprint_length = std::min(m_fingerprint_length, literal.size());
+    m_tag_count = std::max(m_tag_count, tag + 1);
+  }
+  std::vector<char> seen(m_tag_count, 0);
+  for (const auto& literal: literals) {
+    m_distinct_tags += seen[literal.second] == 0 ? 1 : 0;
+    seen[literal.second] = 1;
+  }
+
+  // The sorted literals are spread evenly over the buckets, but a bucket only
+  // starts where the first byte changes. Literals sharing their first byte
+  // thus end up in the same bucket, so they do not pollute the masks of other
+  // buckets.
+  std::vector<std::pair<std::string_view, int>> sorted{literals};
+  std::sort(sorted.begin(), sorted.end());
+  std::size_t bucket{0};
+  for (std::size_t index{0}; index < sorted.size(); ++index) {
+    if (index == 0
+        || sorted[index].first.substr(0, 1)
+               != sorted[index - 1].first.substr(0, 1)) {
+      bucket = index * m_buckets.size() / sorted.size();
+    }
+    m_buckets[bucket].emplace_back(sorted[index].first, sorted[index].second);
+    for (std::size_t position{0}; position < m_fingerprint_length;
+         ++position) {
+      auto byte{static_cast<unsigned char>(sorted[index].first[position])};
+      m_low_masks[position][byte & 0xF] |= 1U << bucket;
+      m_high_masks[position][byte >> 4] |= 1U << bucket;
+    }
+  }
+
+#ifdef REGEXP_TEDDY_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    m_instruction_set = InstructionSet::AVX2;
+  } else if (__builtin_cpu_supports("ssse3")) {
+    m_instruction_set = InstructionSet::SSSE3;
+  }
+#endif
+}
+
+std::vector<int> Teddy::search(std::string_view string) const {
+  Found found{std::vector<char>(m_tag_count, 0), m_distinct_tags};
+  if (m_fingerprint_length != 0) {
+    switch (m_instruction_set) {
+    case InstructionSet::AVX2:
+      searchAvx2(string, found);
+      break;
+    case InstructionSet::SSSE3:
+      searchSsse3(string, found);
+      break;
+    case InstructionSet::SCALAR:
+      searchScalar(string, 0, found);
+      break;
+    }
+  }
+
+  std::vector<int> result{};
+  for (int tag{0}; tag < m_tag_count; ++tag) {
+    if (found.tags[tag] == 1) {
+      result.push_back(tag);
+    }
+  }
+  return result;
+}
+
+const char* Teddy::instructionSet() const {
+  switch (m_instruction_set) {
+  case InstructionSet::AVX2:
+    return "AVX2";
+  case InstructionSet::SSSE3:
+    return "SSSE3";
+  default:
+    return "scalar";
+  }
+}
+
+std::uint8_t Teddy::candidates(std::string_view string,
+                               std::size_t position) const {
+  std::uint8_t buckets{0xFF};
+  for (std::size_t offset{0}; offset < m_fingerprint_length; ++offset) {
+    auto byte{static_cast<unsigned char>(string[position + offset])};
+    buckets &= m_low_masks[offset][byte & 0xF] & m_high_masks[offset][byte >> 4];
+  }
+  return buckets;
+}
+
+void Teddy::verify(std::string_view string, std::size_t position,
+                   std::uint8_t buckets, Found& found) const {
+  for (std::size_t bucket{0}; buckets != 0; ++bucket, buckets >>= 1) {
+    if ((buckets & 1) == 1) {
+      for (const auto& [literal, tag]: m_buckets[bucket]) {
+        if (found.tags[tag] == 0
+            && string.compare(position, literal.size(), literal) == 0) {
+          found.tags[tag] = 1;
+          --found.missing;
+        }
+      }
+    }
+  }
+}
+
+void Teddy::searchScalar(std::string_view string, std::size_t position,
+                         Found& found) const {
+  for (; position + m_fingerprint_length <= string.size() && found.missing != 0;
+       ++position) {
+    if (std::uint8_t buckets{candidates(string, position)}; buckets != 0) {
+      verify(string, position, buckets, found);
+    }
+  }
+}
+
+#ifdef REGEXP_TEDDY_X86
+__attribute__((target("ssse3"))) void Teddy::searchSsse3(
+    std::string_view string, Found& found) const {
+  const __m128i low_nibble{_mm_set1_epi8(0xF)};
+  __m128i low_masks[3];
+  __m128i high_masks[3];
+  for (std::size_t offset{0}; offset < m_fingerprint_length; ++offset) {
+    low_masks[offset] = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(m_low_masks[offset].data()));
+    high_masks[offset] = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(m_high_masks[offset].data()));
+  }
+
+  std::size_t position{0};
+  for (; position + 16 + m_fingerprint_length - 1 <= string.size();
+       position += 16) {
+    __m128i buckets{_mm_set1_epi8(-1)};
+    for (std::size_t offset{0}; offset < m_fingerprint_length; ++offset) {
+      __m128i bytes{_mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(string.data() + position + offset))};
+      __m128i low{_mm_and_si128(bytes, low_nibble)};
+      __m128i high{_mm_and_si128(_mm_srli_epi16(bytes, 4), low_nibble)};
+      buckets = _mm_and_si128(
+          buckets, _mm_and_si128(_mm_shuffle_epi8(low_masks[offset], low),
+                                 _mm_shuffle_epi8(high_masks[offset], high)));
+    }
+
+    auto hits{static_cast<unsigned>(
+        ~_mm_movemask_epi8(_mm_cmpeq_epi8(buckets, _mm_setzero_si128()))
+        & 0xFFFF)};
+    if (hits != 0) {
+      alignas(16) std::uint8_t lanes[16];
+      _mm_store_si128(reinterpret_cast<__m128i*>(lanes), buckets);
+      for (; hits != 0; hits &= hits - 1) {
+        auto lane{static_cast<std::size_t>(__builtin_ctz(hits))};
+        verify(string, position + lane, lanes[lane], found);
+      }
+      if (found.missing == 0) { // Every tag has been found
+        return;
+      }
+    }
+  }
+  searchScalar(string, position, found);
+}
+
+__attribute__((target("avx2"))) void Teddy::searchAvx2(
+    std::string_view string, Found& found) const {
+  const __m256i low_nibble{_mm256_set1_epi8(0xF)};
+  __m256i low_masks[3];
+  __m256i high_masks[3];
+  for (std::size_t offset{0}; offset < m_fingerprint_length; ++offset) {
+    // Shuffles stay within 128-bit lanes, so both lanes get the full table
+    low_masks[offset] = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(m_low_masks[offset].data())));
+    high_masks[offset] = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(m_high_masks[offset].data())));
+  }
+
+  std::size_t position{0};
+  for (; position + 32 + m_fingerprint_length - 1 <= string.size();
+       position += 32) {
+    __m256i buckets{_mm256_set1_epi8(-1)};
+    for (std::size_t offset{0}; offset < m_fingerprint_length; ++offset) {
+      __m256i bytes{_mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(string.data() + position + offset))};
+      __m256i low{_mm256_and_si256(bytes, low_nibble)};
+      __m256i high{_mm256_and_si256(_mm256_srli_epi16(bytes, 4), low_nibble)};
+      buckets = _mm256_and_si256(
+          buckets,
+          _mm256_and_si256(_mm256_shuffle_epi8(low_masks[offset], low),
+                           _mm256_shuffle_epi8(high_masks[offset], high)));
+    }
+
+    auto hits{~static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(buckets, _mm256_setzero_si256())))};
+    if (hits != 0) {
+      alignas(32) std::uint8_t lanes[32];
+      _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), buckets);
+      for (; hits != 0; hits &= hits - 1) {
+        auto lane{static_cast<std::size_t>(__builtin_ctz(hits))};
+        verify(string, position + lane, lanes[lane], found);
+      }
+      if (found.missing == 0) { // Every tag has been found
+        return;
+      }
+    }
+  }
+  searchScalar(string, position, found);
+}
+#else
+void Teddy::searchSsse3(std::string_view string,
+                        Found& found) const {
+  searchScalar(string, 0, found);
+}
+
+void Teddy::searchAvx2(std::string_view string,
+                       Found& found) const {
+  searchScalar(string, 0, found);
+}
+#endif
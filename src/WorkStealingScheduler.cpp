@@ -0,0 +1,97 @@
+/**
+ * This file contains the implementation of the WorkStealingScheduler class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "WorkStealingScheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+WorkStealingScheduler::WorkStealingScheduler(unsigned workers)
+    : m_workers{std::max(workers, 1U)} {}
+
+std::vector<WorkStealingScheduler::WorkerStatistics> WorkStealingScheduler::run(
+    std::size_t tasks,
+    const std::function<void(std::size_t, unsigned)>& execute) {
+  std::vector<Queue> queues(m_workers);
+  for (std::size_t task{0}; task < tasks; ++task) {
+    queues[task * m_workers / tasks].tasks.push_back(task);
+  }
+
+  std::vector<WorkerStatistics> statistics(m_workers);
+  std::atomic<bool> stopped{false};
+  auto work{[&](unsigned worker) {
+    WorkerStatistics& own_statistics{statistics[worker]};
+    std::size_t task{};
+    while (!stopped.load(std::memory_order_relaxed)) {
+      bool stolen{false};
+      if (!pop(queues[worker], task)) {
+        for (unsigned offset{1}; offset < m_workers && !stolen; ++offset) {
+          stolen = steal(queues[(worker + offset) % m_workers], task);
+        }
+        if (!stolen) {
+          return; // No task is ever added during a run, so all work is taken
+        }
+        ++own_statistics.stolen_tasks;
+      }
+
+      auto start{std::chrono::steady_clock::now()};
+      execute(task, worker);
+      own_statistics.busy_seconds += std::chrono::duration<double>{
+          std::chrono::steady_clock::now() - start}.count();
+      ++own_statistics.tasks;
+    }
+  }};
+
+  auto start{std::chrono::steady_clock::now()};
+  std::vector<std::thread> threads{};
+  try {
+    for (unsigned worker{1}; worker < m_workers; ++worker) {
+      threads.emplace_back(work, worker);
+    }
+  } catch (...) {
+    // The workers that did start stop after their current task
+    stopped.store(true, std::memory_order_relaxed);
+    for (auto& thread: threads) {
+      thread.join();
+    }
+    throw;
+  }
+  work(0); // The calling thread acts as the first worker
+  for (auto& thread: threads) {
+    thread.join();
+  }
+  double elapsed{std::chrono::duration<double>{
+      std::chrono::steady_clock::now() - start}.count()};
+
+  for (auto& worker_statistics: statistics) {
+    worker_statistics.utilization =
+        elapsed > 0 ? worker_statistics.busy_seconds / elapsed : 0;
+  }
+  return statistics;
+}
+
+bool WorkStealingScheduler::pop(Queue& queue, std::size_t& task) {
+  std::lock_guard<std::mutex> lock{queue.mutex};
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = queue.tasks.front();
+  queue.tasks.pop_front();
+  return true;
+}
+
+bool WorkStealingScheduler::steal(Queue& queue, std::size_t& task) {
+  std::lock_guard<std::mutex> lock{queue.mutex};
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task = queue.tasks.back();
+  queue.tasks.pop_back();
+  return true;
+}
@@ -7,56 +7,529 @@
  * @copyright GNU General Public License v3.0
  */
 
+#include "BatchMatcher.h"
+#include "BufferedWriter.h"
+#include "CommandPipeline.h"
+#include "GraphExporter.h"
+#include "MappedFile.h"
+#include "MatchClient.h"
+#include "MatchServer.h"
+#include "MatchStatistics.h"
+#include "Matcher.h"
+#include "ParallelMatcher.h"
 #include "RegularExpression.h"
+#include "RegularExpressionSet.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
 #include <iterator>
-#include <sstream>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/**
+ * Match every line of a file against the given RegularExpression. The results
+ * are written to the standard output, while the achieved throughput is
+ * reported on the standard error, along with the utilization of every worker
+ * when multiple threads are used.
+ *
+ * @param path the path of the newline-delimited file to match
+ * @param expression the RegularExpression to match the lines against
+ * @param threads the number of threads to match with
+ */
+void matchFile(const std::string& path, const RegularExpression& expression,
+               unsigned threads) {
+  try {
+    MappedFile file{path};
+    std::cout.flush(); // Keep earlier output in front of the batch results
+
+    auto start{std::chrono::steady_clock::now()};
+    BufferedWriter output{STDOUT_FILENO};
+    BatchMatcher matcher{expression};
+    std::size_t lines{matcher.run(file.contents(), output, threads)};
+    output.flush();
+    std::chrono::duration<double> elapsed{std::chrono::steady_clock::now()
+                                          - start};
+
+    std::cerr << "Matched " << lines << " lines in " << elapsed.count()
+              << " s";
+    if (elapsed.count() > 0) {
+      std::cerr << " (" << static_cast<double>(lines) / elapsed.count()
+                << " lines/sec)";
+    }
+    std::cerr << '\n';
+
+    unsigned worker{0};
+    for (const auto& statistics: matcher.statistics()) {
+      std::cerr << "Worker " << worker++ << ": " << statistics.tasks
+                << " tasks (" << statistics.stolen_tasks << " stolen), "
+                << statistics.utilization * 100 << "% utilization\n";
+    }
+  } catch (const std::system_error& e) {
+    std::cout << "Error while matching file: " << e.what() << '\n';
+  }
+}
+
+/**
+ * Remove the line ending at the end of a text, which matbig and matstream do
+ * not consider part of the string to match: a newline, a carriage return, or
+ * a carriage return followed by a newline.
+ *
+ * @param text the text
+ * @return the text without its line ending
+ */
+std::string_view withoutLineEnding(std::string_view text) {
+  if (!text.empty() && text.back() == '\n') {
+    text.remove_suffix(1);
+  }
+  if (!text.empty() && text.back() == '\r') {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+/**
+ * Check whether the complete contents of a file, without a trailing newline,
+ * are accepted by the given RegularExpression. The time it took is reported on
+ * the standard error.
+ *
+ * @param path the path of the file to match
+ * @param expression the RegularExpression to match the contents against
+ * @param threads the number of threads to match with
+ */
+void matchWholeFile(const std::string& path,
+                    const RegularExpression& expression, unsigned threads) {
+  try {
+    MappedFile file{path};
+    std::string_view contents{withoutLineEnding(file.contents())};
+
+    auto start{std::chrono::steady_clock::now()};
+    bool match{};
+    if (const Dfa* dfa{expression.dfa()}; dfa != nullptr) {
+      match = ParallelMatcher{*dfa, threads}.mat(contents);
+    } else {
+      std::cerr << "No DFA available, matching sequentially\n";
+      match = expression.mat(contents);
+    }
+    std::chrono::duration<double> elapsed{std::chrono::steady_clock::now()
+                                          - start};
+
+    std::cout << (match ? "match" : "no match") << '\n';
+    std::cerr << "Matched " << contents.size() << " bytes in "
+              << elapsed.count() << " s\n";
+  } catch (const std::system_error& e) {
+    std::cout << "Error while matching file: " << e.what() << '\n';
+  }
+}
+
+/**
+ * Check whether everything that can be read from a file, without a trailing
+ * newline, is accepted by the given RegularExpression. The file is read in
+ * chunks of 64 KiB, so it may also be a pipe of unbounded length.
+ *
+ * @param path the path of the file or pipe to read
+ * @param expression the RegularExpression to match the contents against
+ */
+void matchStream(const std::string& path, const RegularExpression& expression) {
+  int descriptor{::open(path.c_str(), O_RDONLY)};
+  if (descriptor == -1) {
+    std::cout << "Error while matching stream: " << path << ": "
+              << std::strerror(errno) << '\n';
+    return;
+  }
+
+  // A line ending is only known to be trailing once the stream ends, so the
+  // last two bytes read, which it could consist of, are held back
+  Matcher matcher{expression};
+  std::vector<char> buffer(1 << 16);
+  std::string held{}; // Short enough to never allocate
+  while (true) {
+    ssize_t result{::read(descriptor, buffer.data(), buffer.size())};
+    if (result == -1 && errno == EINTR) {
+      continue;
+    } else if (result == -1) {
+      std::cout << "Error while matching stream: " << path << ": "
+                << std::strerror(errno) << '\n';
+      ::close(descriptor);
+      return;
+    } else if (result == 0) {
+      break;
+    }
+
+    std::string_view chunk{buffer.data(), static_cast<std::size_t>(result)};
+    if (chunk.size() >= 2) {
+      matcher.feed(held);
+      matcher.feed(chunk.substr(0, chunk.size() - 2));
+      held.assign(chunk.substr(chunk.size() - 2));
+    } else {
+      held.push_back(chunk.front());
+      if (held.size() > 2) {
+        matcher.feed(std::string_view{held}.substr(0, 1));
+        held.erase(0, 1);
+      }
+    }
+  }
+  ::close(descriptor);
+
+  matcher.feed(withoutLineEnding(held));
+  std::cout << (matcher.finish() ? "match" : "no match") << '\n';
+}
+
+/**
+ * Read a set of regular expressions from a file, one expression per line.
+ *
+ * @param path the path of the file to read
+ * @return the set of regular expressions, or nothing if reading failed
+ */
+std::optional<RegularExpressionSet> readSet(const std::string& path) {
+  std::ifstream file{path};
+  if (!file) {
+    std::cout << "Error while reading expressions: cannot open " << path
+              << '\n';
+    return std::nullopt;
+  }
+
+  std::vector<std::string> expressions{};
+  for (std::string line{}; std::getline(file, line);) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    expressions.push_back(std::move(line));
+  }
+  return RegularExpressionSet{expressions};
+}
+
+/**
+ * Print the identifiers of the regular expressions in a set that matched.
+ *
+ * @param matches the identifiers of the matching regular expressions
+ */
+void printMatches(const std::vector<int>& matches) {
+  if (matches.empty()) {
+    std::cout << "no match\n";
+    return;
+  }
+
+  std::cout << "match:";
+  for (auto match: matches) {
+    std::cout << ' ' << match;
+  }
+  std::cout << '\n';
+}
+
+/**
+ * Take the next whitespace-delimited token from a line, as reading a token
+ * from a stream would, without copying it.
+ *
+ * @param line the (remaining) line, which is advanced past the token
+ * @return the token, empty if the rest of the line is blank
+ */
+std::string_view nextToken(std::string_view& line) {
+  auto is_space{[](char character) {
+    return std::isspace(static_cast<unsigned char>(character)) != 0;
+  }};
+  auto begin{std::find_if_not(line.begin(), line.end(), is_space)};
+  auto end{std::find_if(begin, line.end(), is_space)};
+  std::string_view token{line.substr(
+      static_cast<std::size_t>(begin - line.begin()),
+      static_cast<std::size_t>(end - begin))};
+  line.remove_prefix(static_cast<std::size_t>(end - line.begin()));
+  return token;
+}
+
+/**
+ * Read the optional number of threads argument of an operation. The number is
+ * capped at a few threads per core, as more would only compete for the cores
+ * and may not be startable at all.
+ *
+ * @param arguments the remaining arguments of the operation
+ * @param threads the number of threads, left untouched if not provided
+ * @return true if the argument was absent or valid, false otherwise
+ */
+bool readThreads(std::string_view arguments, unsigned& threads) {
+  if (std::string_view token{nextToken(arguments)}; !token.empty()) {
+    std::string threads_token{token};
+    auto max_threads{static_cast<int>(
+        4 * std::max(std::thread::hardware_concurrency(), 1U))};
+    try {
+      threads = static_cast<unsigned>(
+          std::clamp(std::stoi(threads_token), 1, max_threads));
+    } catch (const std::logic_error&) {
+      std::cout << "Invalid number of threads: " << threads_token << '\n';
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Read the optional region arguments of the dot operation: the state to start
+ * from and the maximum distance from it.
+ *
+ * @param arguments the remaining arguments of the operation
+ * @param expression the RegularExpression whose states are referred to
+ * @param state the state, numbered as in the dot notation, left untouched if
+ *              not provided
+ * @param depth the maximum distance, left untouched if not provided
+ * @return true if the arguments were absent or valid, false otherwise
+ */
+bool readRegion(std::string_view arguments,
+                const RegularExpression& expression, int& state,
+                std::size_t& depth) {
+  std::string state_token{nextToken(arguments)};
+  if (state_token.empty()) {
+    return true;
+  }
+  std::string depth_token{nextToken(arguments)};
+
+  int number{0};
+  int distance{-1};
+  try {
+    number = std::stoi(state_token);
+    distance = std::stoi(depth_token);
+  } catch (const std::logic_error&) {
+    // Reported below as an invalid state or depth
+  }
+  if (number < 1 || static_cast<std::size_t>(number) > expression.states()) {
+    std::cout << "Invalid state: " << state_token << '\n';
+    return false;
+  } else if (distance < 0) {
+    std::cout << "Invalid depth: " << depth_token << '\n';
+    return false;
+  }
+  state = number;
+  depth = static_cast<std::size_t>(distance);
+  return true;
+}
+
+/**
+ * The formats an automaton can be exported in.
+ */
+enum class GraphFormat { DOT, BINARY, JSON };
+
+/**
+ * Export the automaton of the given RegularExpression to a file. Dot notation
+ * of large automata is formatted on every available core.
+ *
+ * @param path the path of the file to write to
+ * @param expression the RegularExpression to export
+ * @param format the format to export in
+ * @param state the state to export the region around in dot notation,
+ *              numbered as in the dot notation, or 0 for the whole automaton
+ * @param depth the maximum distance of the region from the state
+ */
+void exportGraph(const std::string& path, const RegularExpression& expression,
+                 GraphFormat format, int state = 0, std::size_t depth = 0) {
+  const char* name{format == GraphFormat::DOT      ? ".dot"
+                   : format == GraphFormat::BINARY ? "edge list"
+                                                   : "JSON"};
+  int descriptor{::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                        0666)};
+  if (descriptor == -1) {
+    std::cout << "Error while exporting " << name << ": " << path << ": "
+              << std::strerror(errno) << '\n';
+    return;
+  }
+
+  try {
+    GraphExporter exporter{expression};
+    if (format == GraphFormat::DOT && state != 0) {
+      exporter.region(descriptor, state, depth);
+    } else if (format == GraphFormat::DOT) {
+      unsigned threads{expression.states() < 4 * GraphExporter::CHUNK_STATES
+                           ? 1
+                           : std::thread::hardware_concurrency()};
+      exporter.dot(descriptor, threads);
+    } else if (format == GraphFormat::BINARY) {
+      exporter.binary(descriptor);
+    } else {
+      exporter.json(descriptor);
+    }
+  } catch (const std::system_error& e) {
+    std::cout << "Error while exporting " << name << ": " << e.what() << '\n';
+  }
+  ::close(descriptor);
+}
+
+/**
+ * Print the measurements taken while constructing the given RegularExpression,
+ * along with the size of its automata and the memory parsing it used.
+ * The DFA is derived first if it was not needed yet, so its build time is
+ * included.
+ *
+ * @param expression the RegularExpression to report on
+ */
+void printProfile(const RegularExpression& expression) {
+  const Dfa* dfa{expression.dfa()};
+  RegularExpression::Profile profile{expression.profile()};
+  std::cout << "parse time: " << profile.parse_seconds * 1e6
+            << " us\nbuild time: " << profile.build_seconds * 1e6
+            << " us\nstates: " << expression.states() << " ("
+            << profile.epsilon_states
+            << " epsilon)\nbytes copied: " << profile.copied_bytes
+            << "\ndfa states: ";
+  if (dfa != nullptr) {
+    std::cout << dfa->size();
+  } else {
+    std::cout << "none";
+  }
+  std::cout << "\nparse memory: "
+            << profile.arena_bytes + profile.automaton_bytes << " bytes (arena "
+            << profile.arena_bytes << ", automaton " << profile.automaton_bytes
+            << ")\n";
+}
+
+/**
+ * Print the work counted while matching since the start of the program or the
+ * last reset, or explain how to enable counting if this build does not count.
+ */
+void printStatistics() {
+  if (!MatchStatistics::ENABLED) {
+    std::cout << "Statistics are not counted by this build; configure with "
+                 "-DREGEXP_STATISTICS=ON\n";
+    return;
+  }
+
+  MatchStatistics statistics{MatchStatistics::total()};
+  std::cout << "matches: "
+            << statistics.literal_matches + statistics.dfa_matches
+                   + statistics.nfa_matches
+            << " (literals " << statistics.literal_matches << ", dfa "
+            << statistics.dfa_matches << ", nfa " << statistics.nfa_matches
+            << ")\nDFA builds: " << statistics.dfa_builds
+            << " (NFA matches while not yet built " << statistics.dfa_deferrals
+            << ")\ncharacters: " << statistics.characters
+            << "\nstates visited: " << statistics.states_visited
+            << "\nclosures: " << statistics.closures
+            << " (max size " << statistics.max_closure << ", average size "
+            << (statistics.closures == 0
+                    ? 0
+                    : static_cast<double>(statistics.states_visited)
+                          / static_cast<double>(statistics.closures))
+            << ")\nallocations: " << statistics.allocations << '\n';
+}
+
+/**
+ * Get the argument of an operation, asking the user for it if the operation
+ * was given without one.
+ *
+ * @param arguments the rest of the operation after its name, which is
+ *                  advanced past the argument
+ * @param whole_line true if the argument is the rest of the operation (e.g. a
+ *                   string to match), false if it is a single token
+ * @param prompt the question to ask the user for the argument
+ * @param storage the string to keep an argument read from the user in
+ * @return the argument
+ */
+std::string_view readArgument(std::string_view& arguments, bool whole_line,
+                              const char* prompt, std::string& storage) {
+  std::string_view remaining{arguments};
+  if (std::string_view token{nextToken(remaining)}; token.empty()) {
+    std::cout << prompt;
+    std::getline(std::cin, storage);
+    arguments = {};
+    return storage;
+  } else if (!whole_line) {
+    arguments = remaining;
+    return token;
+  }
+
+  std::string_view argument{arguments.substr(1)}; // Skip the separating space
+  arguments = {};
+  return argument;
+}
 
 /**
  * Execute a given operation on the given RegularExpression. If an invalid
  * operation is given, we mention this to the user.
  *
+ * The operation is split into tokens without copying, so exp and mat commands
+ * given with their argument do not allocate beyond what they execute.
+ *
  * @param operation the operation we want to execute on given RegularExpression
  * @param expression the RegularExpression we want to execute an operation on
+ * @param expression_set the RegularExpressionSet we want to execute an
+ *                       operation on
  * @return true if the program should continue, false if it should stop
  */
-bool execute(std::string_view operation, RegularExpression& expression) {
-  if (auto carriage_return_index{operation.find('\r')};
-      carriage_return_index != std::string::npos) {
-    operation = operation.substr(0, carriage_return_index);
-  }
-  std::istringstream inputStream{operation.data()};
-  std::string token{};
-  inputStream >> token;
+bool execute(std::string_view operation, RegularExpression& expression,
+             RegularExpressionSet& expression_set) {
+  operation = operation.substr(0, operation.find('\r'));
+  std::string_view arguments{operation};
+  std::string_view token{nextToken(arguments)};
+  std::string storage{};
   if (token == "exp") {
-    if (inputStream >> token) {
-      token = operation.substr(4);
-    } else {
-      std::cout << "Please enter a regular expression:";
-      std::getline(std::cin, token);
-    }
-    expression = RegularExpression{token};
+    expression = RegularExpression{readArgument(
+        arguments, true, "Please enter a regular expression:", storage)};
   } else if (token == "dot") {
-    if (!(inputStream >> token)) {
-      std::cout << "Please enter a filepath to write the output to:";
-      std::getline(std::cin, token);
-    }
-    try {
-      std::ofstream file{token};
-      file << expression.dot();
-    } catch (const std::ofstream::failure& e) {
-      std::cout << "Error while exporting .dot: " << e.what() << '\n';
+    std::string path{readArgument(
+        arguments, false, "Please enter a filepath to write the output to:",
+        storage)};
+    int state{0};
+    std::size_t depth{0};
+    if (readRegion(arguments, expression, state, depth)) {
+      exportGraph(path, expression, GraphFormat::DOT, state, depth);
     }
+  } else if (token == "bin" || token == "jsn") {
+    std::string path{readArgument(
+        arguments, false, "Please enter a filepath to write the output to:",
+        storage)};
+    exportGraph(path, expression,
+                token == "bin" ? GraphFormat::BINARY : GraphFormat::JSON);
   } else if (token == "mat") {
-    if (inputStream >> token) {
-      token = operation.substr(4);
-    } else {
-      std::cout << "Please enter a string to check:";
-      std::getline(std::cin, token);
+    std::string_view string{readArgument(
+        arguments, true, "Please enter a string to check:", storage)};
+    std::cout << (expression.mat(string) ? "match" : "no match") << '\n';
+  } else if (token == "matfile") {
+    std::string path{readArgument(
+        arguments, false, "Please enter a filepath to read the strings from:",
+        storage)};
+    if (unsigned threads{1}; readThreads(arguments, threads)) {
+      matchFile(path, expression, threads);
+    }
+  } else if (token == "matbig") {
+    std::string path{readArgument(
+        arguments, false, "Please enter a filepath to read the string from:",
+        storage)};
+    if (unsigned threads{1}; readThreads(arguments, threads)) {
+      matchWholeFile(path, expression, threads);
+    }
+  } else if (token == "matstream") {
+    std::string path{readArgument(
+        arguments, false, "Please enter a filepath to read the string from:",
+        storage)};
+    matchStream(path, expression);
+  } else if (token == "set") {
+    std::string path{readArgument(
+        arguments, false,
+        "Please enter a filepath to read the expressions from:", storage)};
+    if (std::optional<RegularExpressionSet> loaded{readSet(path)}; loaded) {
+      expression_set = std::move(*loaded);
+    }
+  } else if (token == "any") {
+    printMatches(expression_set.matches(readArgument(
+        arguments, true, "Please enter a string to check:", storage)));
+  } else if (token == "fnd") {
+    printMatches(expression_set.search(readArgument(
+        arguments, true, "Please enter a string to search:", storage)));
+  } else if (token == "prf") {
+    printProfile(expression);
+  } else if (token == "stats") {
+    printStatistics();
+    if (nextToken(arguments) == "reset") {
+      MatchStatistics::reset();
     }
-    std::cout << (expression.mat(token) ? "match" : "no match") << '\n';
   } else if (token == "end") {
     return false;
   } else {
@@ -66,6 +539,71 @@ bool execute(std::string_view operation, RegularExpression& expression) {
   return true;
 }
 
+/**
+ * Serve compile and match requests on a Unix domain socket until the program
+ * is stopped (see MatchServer).
+ *
+ * @param path the path of the socket
+ * @return EXIT_FAILURE, as serving only ends on errors
+ */
+int serve(const std::string& path) {
+  try {
+    MatchServer server{path};
+    server.run();
+  } catch (const std::system_error& e) {
+    std::cout << "Error while serving: " << e.what() << '\n';
+  }
+  return EXIT_FAILURE;
+}
+
+/**
+ * Forward commands read from the standard input to the server listening on a
+ * Unix domain socket. Only exp, mat and end are supported, behaving as they do
+ * in autonomous mode: their arguments are read in the same way, so one that is
+ * left out is asked for on the next line.
+ *
+ * @param path the path of the socket
+ * @return EXIT_SUCCESS if all commands were forwarded, EXIT_FAILURE otherwise
+ */
+int runClient(const std::string& path) {
+  try {
+    MatchClient client{path};
+    std::optional<std::uint32_t> id{};
+    std::string operation{};
+    std::string storage{};
+    while (std::getline(std::cin, operation)) {
+      std::string_view arguments{operation};
+      arguments = arguments.substr(0, arguments.find('\r'));
+      std::string_view token{nextToken(arguments)};
+      if (token == "exp") {
+        std::string_view argument{readArgument(
+            arguments, true, "Please enter a regular expression:", storage)};
+        if (id) {
+          client.release(*id);
+        }
+        id = client.compile(argument);
+      } else if (token == "mat") {
+        std::string_view string{readArgument(
+            arguments, true, "Please enter a string to check:", storage)};
+        if (!id) {
+          id = client.compile("");
+        }
+        std::cout << (client.match(*id, string) ? "match" : "no match")
+                  << '\n';
+      } else if (token == "end") {
+        break;
+      } else {
+        std::cout << "Unknown command: " << (token.empty() ? "(none)" : token)
+                  << '\n';
+      }
+    }
+    return EXIT_SUCCESS;
+  } catch (const std::system_error& e) {
+    std::cout << "Error while talking to server: " << e.what() << '\n';
+    return EXIT_FAILURE;
+  }
+}
+
 /**
  * Entry point of the interactive program.
  *
@@ -74,7 +612,20 @@ bool execute(std::string_view operation, RegularExpression& expression) {
  * @return EXIT_SUCCESS if the program ran successfully, EXIT_FAILURE otherwise
  */
 int main(int argc, char* argv[]) {
-  if (argc <= 2) {
+  if ((argc == 2 || argc == 3) && std::string_view{argv[1]} == "p") {
+    unsigned threads{std::max(std::thread::hardware_concurrency(), 1U)};
+    if (argc == 3 && !readThreads(argv[2], threads)) {
+      return EXIT_FAILURE;
+    }
+    try {
+      CommandPipeline pipeline{threads};
+      pipeline.run(STDIN_FILENO, STDOUT_FILENO);
+      return EXIT_SUCCESS;
+    } catch (const std::exception& e) { // Also running out of memory
+      std::cout << "Error while running pipeline: " << e.what() << '\n';
+      return EXIT_FAILURE;
+    }
+  } else if (argc <= 2) {
     const bool DEBUG = argc == 2 && *argv[1] == 'd';
 
     if (!DEBUG) {
@@ -82,30 +633,59 @@ int main(int argc, char* argv[]) {
     }
 
     RegularExpression expression{};
+    RegularExpressionSet expression_set{};
     std::string operation{};
     while (true) {
       if (!DEBUG) {
         std::cout << "Available operations:\n"
                      " - exp <expression>\tRead in regular expression\n"
-                     " - dot <filename>\tExport regular expression to "
-                     "dot-notation\n"
+                     " - dot <filename> [state depth]\n"
+                     "\t\t\tExport regular expression to dot-notation, "
+                     "optionally only\n"
+                     "\t\t\tthe states within depth edges of a state\n"
+                     " - bin <filename>\tExport regular expression as a "
+                     "binary edge list\n"
+                     " - jsn <filename>\tExport regular expression as JSON "
+                     "adjacency lists\n"
                      " - mat <string>\t\tCheck whether a string is accepted by "
                      "automaton\n"
+                     " - matfile <filename> [threads]\n"
+                     "\t\t\tCheck every line of a file for acceptance\n"
+                     " - matbig <filename> [threads]\n"
+                     "\t\t\tCheck whether a file's contents are accepted\n"
+                     " - matstream <filename>\tCheck whether everything read "
+                     "from a pipe is accepted\n"
+                     " - set <filename>\tRead in regular expressions, one per "
+                     "line\n"
+                     " - any <string>\t\tList the read in expressions "
+                     "accepting a string\n"
+                     " - fnd <string>\t\tList the read in expressions "
+                     "accepting part of a string\n"
+                     " - prf\t\t\tShow how constructing the regular "
+                     "expression went\n"
+                     " - stats [reset]\tShow the work counted while "
+                     "matching\n"
                      " - end\t\t\tClose the program\n"
                      "Please enter an operation. If applicable, you can "
                      "immediately provide\nan argument for the operation:";
       }
 
       if (std::getline(std::cin, operation)) {
-        if (!execute(operation, expression)) {
+        if (!execute(operation, expression, expression_set)) {
           return EXIT_SUCCESS;
         }
       } else if (DEBUG) {
         return EXIT_SUCCESS;
       }
     }
+  } else if (argc == 3 && std::string_view{argv[1]} == "s") {
+    return serve(argv[2]);
+  } else if (argc == 3 && std::string_view{argv[1]} == "c") {
+    return runClient(argv[2]);
   } else {
-    std::cout << "Usage: " << argv[0] << " [d]\n";
+    std::cout << "Usage: " << argv[0] << " [d]\n"
+              << "       " << argv[0] << " p [threads]\n"
+              << "       " << argv[0] << " s|c <socket>\n";
     return EXIT_FAILURE;
   }
 }
@@ -0,0 +1,66 @@
+/**
+ * This file contains the implementation of the C interface to the
+ * RegularExpression class.
+ *
+ * @file
+ * @author Jort van Leenen
+ * @copyright GNU General Public License v3.0
+ */
+
+#include "regexp.h"
+#include "RegularExpression.h"
+#include <string_view>
+
+struct rx_regexp {
+  RegularExpression expression;
+};
+
+struct rx_scratch {
+  RegularExpression::Scratch scratch;
+};
+
+// Exceptions must not cross into C, so any failure is reported by the return
+// values instead
+rx_regexp* rx_compile(const char* pattern, size_t length) {
+  try {
+    return new rx_regexp{RegularExpression{std::string_view{pattern, length}}};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+int rx_match(const rx_regexp* regexp, const char* string, size_t length) {
+  try {
+    return regexp->expression.mat(std::string_view{string, length}) ? 1 : 0;
+  } catch (...) {
+    return -1;
+  }
+}
+
+rx_scratch* rx_scratch_new() {
+  try {
+    return new rx_scratch{};
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+int rx_match_with(const rx_regexp* regexp, rx_scratch* scratch,
+                  const char* string, size_t length) {
+  try {
+    return regexp->expression.mat(std::string_view{string, length},
+                                  scratch->scratch)
+               ? 1
+               : 0;
+  } catch (...) {
+    return -1;
+  }
+}
+
+void rx_scratch_free(rx_scratch* scratch) {
+  delete scratch;
+}
+
+void rx_free(rx_regexp* regexp) {
+  delete regexp;
+}